@@ -0,0 +1,378 @@
+#include "LoadGenerator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+
+namespace SlippiAuth {
+
+    BenchOptions BenchOptions::Parse(int argc, char** argv)
+    {
+        BenchOptions options;
+
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "--json")
+            {
+                options.json = true;
+                continue;
+            }
+
+            if (i + 1 >= argc)
+            {
+                CORE_ERROR("Missing value for {}", arg);
+                break;
+            }
+
+            std::string value = argv[++i];
+            if (arg == "--url")
+                options.url = value;
+            else if (arg == "--connections")
+                options.connections = std::max(std::stoul(value), 1ul);
+            else if (arg == "--requests")
+                options.requests = std::stoull(value);
+            else if (arg == "--rate")
+                options.rate = std::stod(value);
+            else if (arg == "--concurrency")
+                options.concurrency = std::max(std::stoul(value), 1ul);
+            else if (arg == "--timeout")
+                options.timeout = std::stoul(value);
+            else if (arg == "--priority")
+                options.priority = value;
+            else if (arg == "--user-port")
+                options.userPort = std::stoul(value);
+            else
+                CORE_WARN("Unknown option {}", arg);
+        }
+
+        return options;
+    }
+
+    LoadGenerator::LoadGenerator(BenchOptions options)
+        : m_Options(std::move(options))
+    {
+        m_Client.clear_access_channels(websocketpp::log::alevel::all);
+        m_Client.clear_error_channels(websocketpp::log::elevel::all);
+        m_Client.init_asio();
+
+        m_Client.set_open_handler([this](auto&& hdl)
+        {
+            OnOpen(std::forward<decltype(hdl)>(hdl));
+        });
+
+        m_Client.set_message_handler([this](auto&& hdl, auto&& msg)
+        {
+            OnMessage(std::forward<decltype(hdl)>(hdl), std::forward<decltype(msg)>(msg));
+        });
+
+        m_Client.set_fail_handler([this](auto&& hdl)
+        {
+            OnFail(std::forward<decltype(hdl)>(hdl));
+        });
+
+        m_RateTimer = std::make_unique<asio::steady_timer>(m_Client.get_io_service());
+        m_UserTimer = std::make_unique<asio::steady_timer>(m_Client.get_io_service());
+        m_ReapTimer = std::make_unique<asio::steady_timer>(m_Client.get_io_service());
+
+        if (enet_initialize() != 0)
+        {
+            CORE_ERROR("An error occurred while initializing ENet!");
+        }
+
+        ENetAddress address;
+        address.host = ENET_HOST_ANY;
+        address.port = m_Options.userPort;
+        m_UserHost = enet_host_create(&address, 4095, 3, 0, 0);
+
+        if (m_UserHost == nullptr)
+            CORE_WARN("Could not listen on port {}, the bots will not reach the user side", m_Options.userPort);
+    }
+
+    LoadGenerator::~LoadGenerator()
+    {
+        if (m_UserHost)
+            enet_host_destroy(m_UserHost);
+
+        enet_deinitialize();
+    }
+
+    void LoadGenerator::Run()
+    {
+        for (uint32_t i = 0; i < m_Options.connections; i++)
+        {
+            std::error_code ec;
+            WsClient::connection_ptr connection = m_Client.get_connection(m_Options.url, ec);
+            if (ec)
+            {
+                CORE_ERROR("Could not connect to {}: {}", m_Options.url, ec.message());
+                return;
+            }
+
+            m_Client.connect(connection);
+        }
+
+        ScheduleUserTick();
+        m_Client.run();
+
+        // The server went away before every request was answered
+        if (m_EndTime == Clock::time_point{})
+            m_EndTime = Clock::now();
+    }
+
+    void LoadGenerator::OnOpen(const websocketpp::connection_hdl& hdl)
+    {
+        m_Connections.push_back(hdl);
+
+        // Start once every connection is up
+        if (m_Connections.size() < m_Options.connections)
+            return;
+
+        m_StartTime = Clock::now();
+
+        // Nothing to send, report right away
+        if (m_Options.requests == 0)
+        {
+            CheckDone();
+            return;
+        }
+
+        ScheduleReapTick();
+
+        if (m_Options.rate > 0)
+        {
+            ScheduleRateTick();
+        }
+        else
+        {
+            while (m_Sent < m_Options.requests && m_InFlight.size() < m_Options.concurrency)
+                SendQueue();
+        }
+    }
+
+    void LoadGenerator::OnFail(const websocketpp::connection_hdl& hdl)
+    {
+        CORE_ERROR("Websocket connection to {} failed", m_Options.url);
+        m_EndTime = Clock::now();
+        m_Client.stop();
+    }
+
+    void LoadGenerator::OnMessage(const websocketpp::connection_hdl& hdl, const WsClient::message_ptr& msg)
+    {
+        Json message = Json::parse(msg->get_payload(), nullptr, false);
+        if (message.is_discarded() || !message.contains("type"))
+            return;
+
+        std::string type = message["type"];
+
+        // Progress updates, the request is still in flight
+        if (type == "searching" || type == "queued")
+            return;
+
+        // Replies without a discord id can't be matched to a request
+        if (!message.contains("discordId"))
+        {
+            m_Outcomes[type]++;
+            return;
+        }
+
+        OnOutcome(message["discordId"], type);
+    }
+
+    void LoadGenerator::SendQueue()
+    {
+        uint64_t discordId = m_NextDiscordId++;
+
+        // Connect codes only have 4 digits, the discord id is what tells requests apart
+        Json request = {
+                {"type", "queue"},
+                {"discordId", discordId},
+                {"userCode", "BNCH#" + std::to_string(discordId % 10000)},
+                {"timeout", m_Options.timeout},
+                {"priority", m_Options.priority}
+        };
+
+        auto& hdl = m_Connections[m_NextConnection++ % m_Connections.size()];
+
+        std::error_code ec;
+        m_Client.send(hdl, request.dump(), websocketpp::frame::opcode::text, ec);
+        if (ec)
+        {
+            m_Outcomes["sendError"]++;
+            m_Completed++;
+        }
+        else
+        {
+            m_InFlight[discordId] = Clock::now();
+        }
+
+        m_Sent++;
+    }
+
+    void LoadGenerator::OnOutcome(uint64_t discordId, const std::string& type)
+    {
+        // Every connection gets the broadcasts, only count the first one
+        auto iter = m_InFlight.find(discordId);
+        if (iter == m_InFlight.end())
+            return;
+
+        if (type == "authenticated")
+        {
+            std::chrono::duration<double, std::milli> latency = Clock::now() - iter->second;
+            m_LatenciesMs.push_back(latency.count());
+        }
+
+        m_Outcomes[type]++;
+        m_InFlight.erase(iter);
+        m_Completed++;
+
+        if (m_Options.rate <= 0 && m_Sent < m_Options.requests)
+            SendQueue();
+
+        CheckDone();
+    }
+
+    void LoadGenerator::CheckDone()
+    {
+        if (m_Completed < m_Options.requests)
+            return;
+
+        m_EndTime = Clock::now();
+        m_RateTimer->cancel();
+        m_UserTimer->cancel();
+        m_ReapTimer->cancel();
+
+        for (auto& hdl : m_Connections)
+        {
+            std::error_code ec;
+            m_Client.close(hdl, websocketpp::close::status::normal, "", ec);
+        }
+    }
+
+    void LoadGenerator::ScheduleRateTick()
+    {
+        if (m_Sent >= m_Options.requests)
+            return;
+
+        SendQueue();
+
+        auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_Options.rate));
+        m_RateTimer->expires_after(interval);
+        m_RateTimer->async_wait([this](const std::error_code& ec)
+        {
+            if (!ec)
+                ScheduleRateTick();
+        });
+    }
+
+    void LoadGenerator::ScheduleUserTick()
+    {
+        m_UserTimer->expires_after(std::chrono::milliseconds(2));
+        m_UserTimer->async_wait([this](const std::error_code& ec)
+        {
+            if (ec)
+                return;
+
+            ServiceUserHost();
+            ScheduleUserTick();
+        });
+    }
+
+    void LoadGenerator::ScheduleReapTick()
+    {
+        m_ReapTimer->expires_after(std::chrono::seconds(1));
+        m_ReapTimer->async_wait([this](const std::error_code& ec)
+        {
+            if (ec)
+                return;
+
+            // Well past the request timeout, the reply was lost
+            auto deadline = Clock::now() - std::chrono::milliseconds(m_Options.timeout) - std::chrono::seconds(30);
+
+            std::vector<uint64_t> lost;
+            for (auto& [discordId, sentTime] : m_InFlight)
+            {
+                if (sentTime < deadline)
+                    lost.push_back(discordId);
+            }
+
+            for (uint64_t discordId : lost)
+                OnOutcome(discordId, "lost");
+
+            if (m_Completed < m_Options.requests)
+                ScheduleReapTick();
+        });
+    }
+
+    void LoadGenerator::ServiceUserHost()
+    {
+        if (m_UserHost == nullptr)
+            return;
+
+        ENetEvent netEvent;
+        while (enet_host_service(m_UserHost, &netEvent, 0) > 0)
+        {
+            if (netEvent.type == ENET_EVENT_TYPE_CONNECT)
+                m_UserConnections++;
+            else if (netEvent.type == ENET_EVENT_TYPE_RECEIVE)
+                enet_packet_destroy(netEvent.packet);
+        }
+    }
+
+    void LoadGenerator::PrintReport() const
+    {
+        std::vector<double> latencies = m_LatenciesMs;
+        std::sort(latencies.begin(), latencies.end());
+
+        auto percentile = [&](double p)
+        {
+            if (latencies.empty())
+                return 0.0;
+
+            size_t index = std::min((size_t)(p * (double)latencies.size()), latencies.size() - 1);
+            return latencies[index];
+        };
+
+        // Nothing was sent if the connections never all opened
+        std::chrono::duration<double> elapsed{};
+        if (m_StartTime != Clock::time_point{} && m_EndTime > m_StartTime)
+            elapsed = m_EndTime - m_StartTime;
+        double throughput = elapsed.count() > 0 ? (double)m_Completed / elapsed.count() : 0.0;
+
+        if (m_Options.json)
+        {
+            Json report = {
+                    {"requests", m_Sent},
+                    {"completed", m_Completed},
+                    {"elapsedSeconds", elapsed.count()},
+                    {"throughput", throughput},
+                    {"latencyMs", {
+                            {"p50", percentile(0.5)},
+                            {"p99", percentile(0.99)},
+                            {"p999", percentile(0.999)},
+                            {"max", latencies.empty() ? 0.0 : latencies.back()}
+                    }},
+                    {"outcomes", m_Outcomes},
+                    {"userConnections", m_UserConnections}
+            };
+
+            std::cout << report.dump(2) << std::endl;
+            return;
+        }
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << "Requests:    " << m_Sent << " sent, " << m_Completed << " completed in "
+                  << elapsed.count() << "s\n"
+                  << "Throughput:  " << throughput << " req/s\n"
+                  << "Latency:     p50 " << percentile(0.5) << "ms, p99 " << percentile(0.99)
+                  << "ms, p999 " << percentile(0.999) << "ms\n"
+                  << "User side:   " << m_UserConnections << " bot connections\n"
+                  << "Outcomes:\n";
+
+        for (auto& [type, count] : m_Outcomes)
+            std::cout << "  " << std::left << std::setw(16) << type << count << "\n";
+
+        std::cout << std::flush;
+    }
+
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+// Use standalone asio instead of boost::asio
+#define ASIO_STANDALONE
+
+#include "SlippiAuth/Core.h"
+
+#include <websocketpp/config/asio_no_tls_client.hpp>
+#include <websocketpp/client.hpp>
+#include <enet/enet.h>
+
+#include <chrono>
+#include <map>
+#include <unordered_map>
+
+namespace SlippiAuth {
+
+    struct BenchOptions
+    {
+        std::string url = "ws://127.0.0.1:9002";
+        uint32_t connections = 1;
+        uint64_t requests = 100;
+        // Queue requests per second, 0 keeps `concurrency` requests in flight instead
+        double rate = 0.0;
+        uint32_t concurrency = 8;
+        uint32_t timeout = 10000;
+        std::string priority = "normal";
+        // Port the bots connect to once matched, the mock has to advertise it as the user address.
+        // Not the default opponentPort of the mock, which may serve the opponent itself on the same host.
+        uint16_t userPort = 43115;
+        bool json = false;
+
+        static BenchOptions Parse(int argc, char** argv);
+    };
+
+    // Fires queue requests at a running SlippiAuth and measures queue to authenticated latency
+    class LoadGenerator
+    {
+    public:
+        using WsClient = websocketpp::client<websocketpp::config::asio_client>;
+        using Clock = std::chrono::steady_clock;
+
+        explicit LoadGenerator(BenchOptions options);
+        ~LoadGenerator();
+
+        void Run();
+        void PrintReport() const;
+    private:
+        void OnOpen(const websocketpp::connection_hdl& hdl);
+        void OnMessage(const websocketpp::connection_hdl& hdl, const WsClient::message_ptr& msg);
+        void OnFail(const websocketpp::connection_hdl& hdl);
+
+        void SendQueue();
+        void OnOutcome(uint64_t discordId, const std::string& type);
+        void CheckDone();
+
+        void ScheduleRateTick();
+        void ScheduleUserTick();
+        // Give up on the requests the server never answered
+        void ScheduleReapTick();
+        // Play the user side: accept the bots connecting after a match
+        void ServiceUserHost();
+    private:
+        BenchOptions m_Options;
+        WsClient m_Client;
+        std::unique_ptr<asio::steady_timer> m_RateTimer;
+        std::unique_ptr<asio::steady_timer> m_UserTimer;
+        std::unique_ptr<asio::steady_timer> m_ReapTimer;
+
+        std::vector<websocketpp::connection_hdl> m_Connections;
+        size_t m_NextConnection = 0;
+
+        // Every outgoing request gets its own discord id to match the replies
+        uint64_t m_NextDiscordId = 1;
+        std::unordered_map<uint64_t, Clock::time_point> m_InFlight;
+
+        uint64_t m_Sent = 0;
+        uint64_t m_Completed = 0;
+        uint64_t m_UserConnections = 0;
+        std::vector<double> m_LatenciesMs;
+        std::map<std::string, uint64_t> m_Outcomes;
+
+        Clock::time_point m_StartTime;
+        Clock::time_point m_EndTime;
+
+        ENetHost* m_UserHost = nullptr;
+    };
+
+}
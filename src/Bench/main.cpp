@@ -0,0 +1,11 @@
+#include "LoadGenerator.h"
+
+int main(int argc, char** argv)
+{
+    // Init logs
+    SlippiAuth::Log::Init();
+
+    SlippiAuth::LoadGenerator generator(SlippiAuth::BenchOptions::Parse(argc, argv));
+    generator.Run();
+    generator.PrintReport();
+}
@@ -0,0 +1,48 @@
+#include "Simulation/SimulatedNetwork.h"
+#include "SlippiAuth/AppConfig.h"
+#include "SlippiAuth/Client/ClientPool.h"
+
+#include <benchmark/benchmark.h>
+
+namespace SlippiAuth {
+
+    static void BM_FindReadyClientIndex(benchmark::State& state)
+    {
+        Json accounts = Json::array();
+        for (int64_t i = 0; i < state.range(0); i++)
+        {
+            accounts.push_back({
+                {"uid", "uid" + std::to_string(i)},
+                {"playKey", "playKey"},
+                {"connectCode", "BOT#" + std::to_string(i % 10000)}
+            });
+        }
+        ClientConfig::Set(accounts);
+
+        // Nothing but the pool: no files, no watcher and no real network
+        Json config = AppConfig::Get();
+        config["journal"]["path"] = "";
+        config["outcomes"]["path"] = "";
+        config["client"]["hotReload"] = false;
+        config["scheduler"]["laneTimer"] = false;
+        AppConfig::Set(config);
+
+        SimulatedNetwork network(MockScript(), 0);
+        ClientPool pool(network);
+
+        // Keep one client out of ten ready, spread over the pool like in a busy period
+        for (auto& client : pool.GetClients())
+        {
+            if (client.GetId() % 10 != 9)
+                client.PreStart("USER#1", 0, 0, 0);
+        }
+
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(pool.FindReadyClientIndex());
+        }
+        state.SetComplexityN(state.range(0));
+    }
+    BENCHMARK(BM_FindReadyClientIndex)->RangeMultiplier(10)->Range(10, 10000)->Complexity();
+
+}
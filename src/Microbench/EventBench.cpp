@@ -0,0 +1,77 @@
+#include "SlippiAuth/Events/ClientEvent.h"
+#include "SlippiAuth/Events/ClientPoolEvent.h"
+#include "SlippiAuth/Events/ServerEvent.h"
+
+#include <benchmark/benchmark.h>
+
+namespace SlippiAuth {
+
+    namespace {
+
+        // Mirrors Server::OnEvent, the event matches the last handler
+        class DispatchTarget
+        {
+        public:
+            void OnEvent(Event& e)
+            {
+                EventDispatcher dispatcher(e);
+                dispatcher.Dispatch<SearchingEvent>(BIND_EVENT_FN(DispatchTarget::OnSearching));
+                dispatcher.Dispatch<AuthenticatedEvent>(BIND_EVENT_FN(DispatchTarget::OnAuthenticated));
+                dispatcher.Dispatch<SlippiErrorEvent>(BIND_EVENT_FN(DispatchTarget::OnSlippiError));
+                dispatcher.Dispatch<NoReadyClientEvent>(BIND_EVENT_FN(DispatchTarget::OnNoReadyClient));
+                dispatcher.Dispatch<QueuedEvent>(BIND_EVENT_FN(DispatchTarget::OnQueued));
+                dispatcher.Dispatch<CancelledEvent>(BIND_EVENT_FN(DispatchTarget::OnCancelled));
+                dispatcher.Dispatch<UpstreamDownEvent>(BIND_EVENT_FN(DispatchTarget::OnUpstreamDown));
+                dispatcher.Dispatch<TimeoutEvent>(BIND_EVENT_FN(DispatchTarget::OnTimeout));
+            }
+
+            uint64_t Count = 0;
+        private:
+            bool OnSearching(SearchingEvent& e) { Count++; return true; }
+            bool OnAuthenticated(AuthenticatedEvent& e) { Count++; return true; }
+            bool OnSlippiError(SlippiErrorEvent& e) { Count++; return true; }
+            bool OnNoReadyClient(NoReadyClientEvent& e) { Count++; return true; }
+            bool OnQueued(QueuedEvent& e) { Count++; return true; }
+            bool OnCancelled(CancelledEvent& e) { Count++; return true; }
+            bool OnUpstreamDown(UpstreamDownEvent& e) { Count++; return true; }
+            bool OnTimeout(TimeoutEvent& e) { Count++; return true; }
+        };
+
+    }
+
+    static void BM_EventDispatch(benchmark::State& state)
+    {
+        DispatchTarget target;
+        TimeoutEvent event(582645006100201485ull, "XXX#123");
+
+        for (auto _ : state)
+        {
+            target.OnEvent(event);
+        }
+        benchmark::DoNotOptimize(target.Count);
+    }
+    BENCHMARK(BM_EventDispatch);
+
+    static void BM_EventToString(benchmark::State& state)
+    {
+        AuthenticatedEvent event(582645006100201485ull, "XXX#123", "Ananas", "12.34.56.78");
+
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(event.ToString());
+        }
+    }
+    BENCHMARK(BM_EventToString);
+
+    static void BM_QueueEventToString(benchmark::State& state)
+    {
+        QueueEvent event("XXX#123", 10000, 582645006100201485ull, QueuePriority::High);
+
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(event.ToString());
+        }
+    }
+    BENCHMARK(BM_QueueEventToString);
+
+}
@@ -0,0 +1,86 @@
+#include "SlippiAuth/Core.h"
+
+#include <benchmark/benchmark.h>
+
+namespace SlippiAuth {
+
+    static const std::string s_GetTicketResp = R"({
+        "type": "get-ticket-resp",
+        "latestVersion": "3.4.0",
+        "matchId": "mode.direct-2021-06-04T17:37:31.07-0",
+        "isHost": true,
+        "players": [
+            {"uid": "abcdefghijklmnopqrstuvwxyz12", "displayName": "Ananas", "connectCode": "XXX#123",
+             "ipAddress": "12.34.56.78:41001", "ipAddressLan": "192.168.1.12:41001", "port": 1},
+            {"uid": "bcdefghijklmnopqrstuvwxyz123", "displayName": "Auth bot", "connectCode": "AUTH#123",
+             "ipAddress": "87.65.43.21:41000", "ipAddressLan": "127.0.0.1:41000", "port": 2}
+        ]
+    })";
+
+    static void BM_ParseGetTicketResp(benchmark::State& state)
+    {
+        for (auto _ : state)
+        {
+            Json message = Json::parse(s_GetTicketResp);
+            benchmark::DoNotOptimize(message);
+        }
+        state.SetBytesProcessed(state.iterations() * (int64_t)s_GetTicketResp.size());
+    }
+    BENCHMARK(BM_ParseGetTicketResp);
+
+    static void BM_DumpCreateTicket(benchmark::State& state)
+    {
+        std::string connectCode = "XXX#123";
+        std::vector<uint8_t> connectCodeBuf(connectCode.begin(), connectCode.end());
+
+        for (auto _ : state)
+        {
+            Json request = {
+                    {"type", "create-ticket"},
+                    {"user", {{"uid", "abcdefghijklmnopqrstuvwxyz12"}, {"playKey", "0123456789abcdef"}}},
+                    {"search", {{"mode", 2}, {"connectCode", connectCodeBuf}}},
+                    {"appVersion", "3.4.0"},
+                    {"ipAddressLan", "127.0.0.1:41000"},
+            };
+            benchmark::DoNotOptimize(request.dump());
+        }
+    }
+    BENCHMARK(BM_DumpCreateTicket);
+
+    // Build and serialize every message the server sends, the way Server does
+    static void BM_DumpOutgoing(benchmark::State& state)
+    {
+        static const std::vector<std::pair<std::string, std::function<Json()>>> s_Messages = {
+            {"searching", [] { return Json{{"type", "searching"}, {"discordId", 582645006100201485ull},
+                                           {"botCode", "AUTH#123"}, {"userCode", "XXX#123"}}; }},
+            {"authenticated", [] { return Json{{"type", "authenticated"}, {"discordId", 582645006100201485ull},
+                                               {"userCode", "XXX#123"}, {"userName", "Ananas"},
+                                               {"userIp", "12.34.56.78"}}; }},
+            {"slippiErr", [] { return Json{{"type", "slippiErr"}, {"discordId", 582645006100201485ull},
+                                           {"userCode", "XXX#123"}}; }},
+            {"timeout", [] { return Json{{"type", "timeout"}, {"discordId", 582645006100201485ull},
+                                         {"userCode", "XXX#123"}}; }},
+            {"noReadyClient", [] { return Json{{"type", "noReadyClient"}, {"discordId", 582645006100201485ull},
+                                               {"userCode", "XXX#123"}}; }},
+            {"queued", [] { return Json{{"type", "queued"}, {"discordId", 582645006100201485ull},
+                                        {"userCode", "XXX#123"}, {"position", 2}}; }},
+            {"cancelled", [] { return Json{{"type", "cancelled"}, {"discordId", 582645006100201485ull},
+                                           {"userCode", "XXX#123"}}; }},
+            {"upstreamDown", [] { return Json{{"type", "upstreamDown"}, {"discordId", 582645006100201485ull},
+                                              {"userCode", "XXX#123"}, {"retryAfter", 2000}}; }},
+            {"rateLimited", [] { return Json{{"type", "rateLimited"}, {"discordId", 582645006100201485ull},
+                                             {"userCode", "XXX#123"}, {"retryAfter", 4200}}; }},
+            {"missingArg", [] { return Json{{"type", "missingArg"}, {"what", "code, timeout or discordId"}}; }},
+        };
+
+        auto& [name, build] = s_Messages[state.range(0)];
+        state.SetLabel(name);
+
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(build().dump());
+        }
+    }
+    BENCHMARK(BM_DumpOutgoing)->DenseRange(0, 9);
+
+}
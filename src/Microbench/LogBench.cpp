@@ -0,0 +1,65 @@
+#include <spdlog/sinks/null_sink.h>
+
+#include <benchmark/benchmark.h>
+
+namespace SlippiAuth {
+
+    // Format through the real client logger into a null sink
+    static void BM_ClientLogFormatted(benchmark::State& state)
+    {
+        auto& logger = Log::GetClientLogger();
+        auto sinks = logger->sinks();
+        logger->sinks() = { std::make_shared<spdlog::sinks::null_sink_mt>() };
+        logger->set_level(spdlog::level::trace);
+
+        std::string host = "mm.slippi.gg";
+        for (auto _ : state)
+        {
+            CLIENT_ERROR(0, "Failed to connect to {}:{}", host, 43113);
+        }
+
+        logger->set_level(spdlog::level::off);
+        logger->sinks() = sinks;
+    }
+    BENCHMARK(BM_ClientLogFormatted);
+
+    // A trace call below the client level, what every hot path pays in production
+    static void BM_ClientLogFiltered(benchmark::State& state)
+    {
+        Log::SetClientLevel(spdlog::level::info);
+
+        std::string host = "mm.slippi.gg";
+        for (auto _ : state)
+        {
+            CLIENT_TRACE(0, "Connecting to {}:{}", host, 43113);
+        }
+
+        Log::SetClientLevel(spdlog::level::trace);
+        Log::GetClientLogger()->set_level(spdlog::level::off);
+    }
+    BENCHMARK(BM_ClientLogFiltered);
+
+    // The same filtered call once one client has its own level, the others look it up
+    static void BM_ClientLogFilteredWithOverride(benchmark::State& state)
+    {
+        Log::SetClientLevel(spdlog::level::info);
+        Log::SetClientLevel(1, spdlog::level::trace);
+
+        auto& logger = Log::GetClientLogger();
+        auto sinks = logger->sinks();
+        logger->sinks() = { std::make_shared<spdlog::sinks::null_sink_mt>() };
+
+        std::string host = "mm.slippi.gg";
+        for (auto _ : state)
+        {
+            CLIENT_TRACE(0, "Connecting to {}:{}", host, 43113);
+        }
+
+        Log::SetClientLevel(1, spdlog::level::info);
+        Log::SetClientLevel(spdlog::level::trace);
+        logger->set_level(spdlog::level::off);
+        logger->sinks() = sinks;
+    }
+    BENCHMARK(BM_ClientLogFilteredWithOverride);
+
+}
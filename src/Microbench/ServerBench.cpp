@@ -0,0 +1,108 @@
+#include "SlippiAuth/Server/Server.h"
+
+#include <websocketpp/config/asio_no_tls_client.hpp>
+#include <websocketpp/client.hpp>
+
+#include <benchmark/benchmark.h>
+
+namespace SlippiAuth {
+
+    namespace {
+
+        // A server with websocket clients connected over loopback, kept for the whole run
+        class FanOutHarness
+        {
+        public:
+            using WsClient = websocketpp::client<websocketpp::config::asio_client>;
+
+            static FanOutHarness& Get()
+            {
+                static FanOutHarness s_Harness;
+                return s_Harness;
+            }
+
+            ~FanOutHarness()
+            {
+                m_Client.stop_perpetual();
+                m_Client.stop();
+                m_Server.Stop();
+
+                m_ClientThread.join();
+                m_ServerThread.join();
+            }
+
+            // Open connections until the server sees `count` of them
+            bool Connect(size_t count)
+            {
+                while (m_ConnectionCount < count)
+                {
+                    std::error_code ec;
+                    auto connection = m_Client.get_connection("ws://127.0.0.1:" + std::to_string(s_Port), ec);
+                    if (ec)
+                        return false;
+
+                    m_Client.connect(connection);
+                    m_ConnectionCount++;
+                }
+
+                auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+                while (m_Server.GetConnectionCount() < count)
+                {
+                    if (std::chrono::steady_clock::now() > deadline)
+                        return false;
+
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+
+                return true;
+            }
+
+            Server& GetServer()
+            {
+                return m_Server;
+            }
+        private:
+            FanOutHarness() : m_Server(s_Port)
+            {
+                m_ServerThread = std::thread([this]() { m_Server.Start(); });
+
+                m_Client.clear_access_channels(websocketpp::log::alevel::all);
+                m_Client.clear_error_channels(websocketpp::log::elevel::all);
+                m_Client.init_asio();
+                m_Client.start_perpetual();
+                m_ClientThread = std::thread([this]() { m_Client.run(); });
+            }
+        private:
+            static constexpr uint16_t s_Port = 19002;
+
+            Server m_Server;
+            std::thread m_ServerThread;
+
+            WsClient m_Client;
+            std::thread m_ClientThread;
+            size_t m_ConnectionCount = 0;
+        };
+
+    }
+
+    static void BM_ServerFanOut(benchmark::State& state)
+    {
+        auto& harness = FanOutHarness::Get();
+        if (!harness.Connect(state.range(0)))
+        {
+            state.SkipWithError("Could not connect the websocket clients");
+            return;
+        }
+
+        TimeoutEvent event(582645006100201485ull, "XXX#123");
+
+        for (auto _ : state)
+        {
+            harness.GetServer().OnEvent(event);
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+    // Sends queue up in websocketpp, a fixed iteration count keeps the memory bounded
+    BENCHMARK(BM_ServerFanOut)->RangeMultiplier(4)->Range(1, 256)->Iterations(2000)->UseRealTime();
+
+}
@@ -0,0 +1,32 @@
+#include <benchmark/benchmark.h>
+
+int main(int argc, char** argv)
+{
+    // Init logs, everything stays quiet unless a benchmark turns its logger on
+    SlippiAuth::Log::Init();
+    spdlog::set_level(spdlog::level::off);
+
+    // Write json results by default so runs can be compared across commits
+    std::vector<char*> args(argv, argv + argc);
+    std::string outArg = "--benchmark_out=microbench.json";
+    std::string formatArg = "--benchmark_out_format=json";
+
+    bool hasOut = std::any_of(args.begin(), args.end(), [](const char* arg)
+    {
+        return std::string(arg).rfind("--benchmark_out=", 0) == 0;
+    });
+
+    if (!hasOut)
+    {
+        args.push_back(outArg.data());
+        args.push_back(formatArg.data());
+    }
+
+    int count = (int)args.size();
+    benchmark::Initialize(&count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(count, args.data()))
+        return 1;
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+}
@@ -0,0 +1,36 @@
+#include "MockScript.h"
+
+namespace SlippiAuth {
+
+    MockScript MockScript::Load(const std::string& path)
+    {
+        MockScript script;
+
+        std::ifstream scriptJson(path);
+        if (!scriptJson.is_open())
+        {
+            CORE_WARN("Could not open {}, using the default script", path);
+            return script;
+        }
+
+        Json data;
+        scriptJson >> data;
+
+        script.port = data.value("port", script.port);
+        script.httpPort = data.value("httpPort", script.httpPort);
+        script.opponentIp = data.value("opponentIp", script.opponentIp);
+        script.opponentPort = data.value("opponentPort", script.opponentPort);
+        script.serveOpponent = data.value("serveOpponent", script.serveOpponent);
+        script.latestVersion = data.value("latestVersion", script.latestVersion);
+        script.matchDelay = data.value("matchDelay", script.matchDelay);
+        script.matchJitter = data.value("matchJitter", script.matchJitter);
+        script.createErrorRate = data.value("createErrorRate", script.createErrorRate);
+        script.ticketErrorRate = data.value("ticketErrorRate", script.ticketErrorRate);
+        script.noMatchRate = data.value("noMatchRate", script.noMatchRate);
+        script.httpErrorRate = data.value("httpErrorRate", script.httpErrorRate);
+        script.seed = data.value("seed", script.seed);
+
+        return script;
+    }
+
+}
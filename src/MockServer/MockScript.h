@@ -0,0 +1,38 @@
+#pragma once
+
+#include "SlippiAuth/Core.h"
+
+namespace SlippiAuth {
+
+    // What the mock answers, loaded from a json file so runs can be replayed
+    struct MockScript
+    {
+        // ENet matchmaking port
+        uint16_t port = 43113;
+        // Stub users-rest port
+        uint16_t httpPort = 8080;
+
+        // Where the matched "user" can be reached, answered as the player ip address
+        std::string opponentIp = "127.0.0.1";
+        uint16_t opponentPort = 43114;
+        // Accept the bots connections to the opponent address ourselves
+        bool serveOpponent = true;
+
+        std::string latestVersion = "3.4.0";
+
+        // Time between create-ticket and the match, in milliseconds
+        uint32_t matchDelay = 1500;
+        uint32_t matchJitter = 500;
+
+        // Probabilities of the scripted failures
+        double createErrorRate = 0.0;
+        double ticketErrorRate = 0.0;
+        double noMatchRate = 0.0;
+        double httpErrorRate = 0.0;
+
+        uint32_t seed = 0;
+
+        static MockScript Load(const std::string& path);
+    };
+
+}
@@ -0,0 +1,297 @@
+#include "MockServer.h"
+
+namespace SlippiAuth {
+
+    MockServer::MockServer(MockScript script)
+        : m_Script(std::move(script)),
+        m_Random(m_Script.seed),
+        m_HttpRandom(m_Script.seed ^ 0x9E3779B9u)
+    {
+        if (enet_initialize() != 0)
+        {
+            CORE_ERROR("An error occurred while initializing ENet!");
+        }
+
+        ENetAddress address;
+        address.host = ENET_HOST_ANY;
+        address.port = m_Script.port;
+        m_Host = enet_host_create(&address, 4095, 3, 0, 0);
+
+        if (m_Host == nullptr)
+            CORE_ERROR("Failed to create the matchmaking host on port {}", m_Script.port);
+
+        if (m_Script.serveOpponent)
+        {
+            address.port = m_Script.opponentPort;
+            m_OpponentHost = enet_host_create(&address, 4095, 3, 0, 0);
+
+            if (m_OpponentHost == nullptr)
+                CORE_ERROR("Failed to create the opponent host on port {}", m_Script.opponentPort);
+        }
+    }
+
+    MockServer::~MockServer()
+    {
+        Stop();
+
+        if (m_HttpThread.joinable())
+            m_HttpThread.join();
+
+        if (m_OpponentHost)
+            enet_host_destroy(m_OpponentHost);
+
+        if (m_Host)
+            enet_host_destroy(m_Host);
+
+        enet_deinitialize();
+    }
+
+    void MockServer::Run()
+    {
+        if (m_Host == nullptr)
+            return;
+
+        m_Running = true;
+        m_HttpThread = std::thread([this]() { ServeHttp(); });
+
+        CORE_INFO("Mock matchmaking on port {}, users-rest on port {}", m_Script.port, m_Script.httpPort);
+
+        while (m_Running)
+        {
+            ENetEvent netEvent;
+            if (enet_host_service(m_Host, &netEvent, 5) > 0)
+            {
+                // Handle everything that is ready before looking at the timers
+                do
+                {
+                    switch (netEvent.type)
+                    {
+                        case ENET_EVENT_TYPE_RECEIVE:
+                        {
+                            std::string payload(netEvent.packet->data,
+                                                netEvent.packet->data + netEvent.packet->dataLength);
+                            enet_packet_destroy(netEvent.packet);
+
+                            try
+                            {
+                                OnReceive(netEvent.peer, Json::parse(payload));
+                            }
+                            catch (const Json::exception& e)
+                            {
+                                CORE_WARN("Invalid message from a client: {}", e.what());
+                            }
+                            break;
+                        }
+                        case ENET_EVENT_TYPE_DISCONNECT:
+                            OnDisconnect(netEvent.peer);
+                            break;
+                        default:
+                            break;
+                    }
+                } while (enet_host_check_events(m_Host, &netEvent) > 0);
+            }
+
+            SendDueTickets();
+            ServiceOpponentHost();
+        }
+
+        CORE_INFO("Mock stopped after {} tickets and {} matches", m_TicketCount, m_MatchCount);
+    }
+
+    void MockServer::Stop()
+    {
+        m_Running = false;
+        m_HttpContext.stop();
+    }
+
+    void MockServer::OnReceive(ENetPeer* peer, const Json& message)
+    {
+        if (message.value("type", "") != "create-ticket")
+        {
+            Send(peer, {{"type", "unknown"}, {"error", "Unsupported message"}});
+            return;
+        }
+
+        m_TicketCount++;
+
+        if (Roll(m_Random, m_Script.createErrorRate))
+        {
+            Send(peer, {{"type", "create-ticket-resp"}, {"error", "Scripted create-ticket error"}});
+            return;
+        }
+
+        // The connect code is sent as an array of bytes
+        std::string targetConnectCode;
+        for (auto& byte : message["search"]["connectCode"])
+            targetConnectCode.push_back((char)byte.get<int>());
+
+        Send(peer, {{"type", "create-ticket-resp"}});
+
+        if (Roll(m_Random, m_Script.noMatchRate))
+            return;
+
+        std::uniform_int_distribution<uint32_t> jitter(0, m_Script.matchJitter);
+        m_Tickets.push_back({
+            peer,
+            targetConnectCode,
+            enet_time_get() + m_Script.matchDelay + jitter(m_Random),
+            Roll(m_Random, m_Script.ticketErrorRate)
+        });
+    }
+
+    void MockServer::OnDisconnect(ENetPeer* peer)
+    {
+        // Leaving matchmaking drops the ticket like on the real server
+        m_Tickets.erase(std::remove_if(m_Tickets.begin(), m_Tickets.end(), [peer](const Ticket& ticket)
+        {
+            return ticket.peer == peer;
+        }), m_Tickets.end());
+    }
+
+    void MockServer::SendDueTickets()
+    {
+        uint32_t now = enet_time_get();
+
+        for (auto iter = m_Tickets.begin(); iter != m_Tickets.end();)
+        {
+            if (iter->dueTime > now)
+            {
+                iter++;
+                continue;
+            }
+
+            if (iter->willError)
+            {
+                Send(iter->peer, {
+                        {"type", "get-ticket-resp"},
+                        {"error", "Scripted get-ticket error"},
+                        {"latestVersion", m_Script.latestVersion}
+                });
+            }
+            else
+            {
+                std::string opponentAddress = m_Script.opponentIp + ":" + std::to_string(m_Script.opponentPort);
+                Send(iter->peer, {
+                        {"type", "get-ticket-resp"},
+                        {"players", {
+                                {
+                                        {"connectCode", iter->targetConnectCode},
+                                        {"displayName", "Mock"},
+                                        {"ipAddress", opponentAddress}
+                                }
+                        }}
+                });
+                m_MatchCount++;
+            }
+
+            iter = m_Tickets.erase(iter);
+        }
+    }
+
+    void MockServer::ServiceOpponentHost()
+    {
+        if (m_OpponentHost == nullptr)
+            return;
+
+        // Only accept the connections, the bots hang up by themselves
+        ENetEvent netEvent;
+        while (enet_host_service(m_OpponentHost, &netEvent, 0) > 0)
+        {
+            if (netEvent.type == ENET_EVENT_TYPE_RECEIVE)
+                enet_packet_destroy(netEvent.packet);
+        }
+    }
+
+    void MockServer::Send(ENetPeer* peer, const Json& message)
+    {
+        std::string contents = message.dump();
+        ENetPacket* packet = enet_packet_create(contents.c_str(), contents.length(), ENET_PACKET_FLAG_RELIABLE);
+        enet_peer_send(peer, 0, packet);
+    }
+
+    bool MockServer::Roll(std::mt19937& random, double probability)
+    {
+        return std::uniform_real_distribution<double>(0.0, 1.0)(random) < probability;
+    }
+
+    void MockServer::ServeHttp()
+    {
+        try
+        {
+            asio::ip::tcp::acceptor acceptor(m_HttpContext, asio::ip::tcp::endpoint(asio::ip::tcp::v4(), m_Script.httpPort));
+            AcceptHttp(acceptor);
+
+            // Returns once Stop stops the context
+            m_HttpContext.run();
+        }
+        catch (const std::exception& e)
+        {
+            CORE_ERROR("Mock users-rest stopped: {}", e.what());
+        }
+    }
+
+    void MockServer::AcceptHttp(asio::ip::tcp::acceptor& acceptor)
+    {
+        acceptor.async_accept([this, &acceptor](const asio::error_code& acceptError, asio::ip::tcp::socket socket)
+        {
+            if (acceptError || !m_Running)
+                return;
+
+            // One request per connection is all the clients need
+            asio::error_code ec;
+            asio::streambuf buffer;
+            asio::read_until(socket, buffer, "\r\n\r\n", ec);
+            if (!ec)
+            {
+                std::istream stream(&buffer);
+                std::string requestLine;
+                std::getline(stream, requestLine);
+
+                asio::write(socket, asio::buffer(HandleHttpRequest(requestLine)), ec);
+                socket.shutdown(asio::ip::tcp::socket::shutdown_both, ec);
+            }
+
+            AcceptHttp(acceptor);
+        });
+    }
+
+    std::string MockServer::HandleHttpRequest(const std::string& requestLine)
+    {
+        // GET /user/<uid> HTTP/1.1
+        std::istringstream line(requestLine);
+        std::string method, target;
+        line >> method >> target;
+
+        int status = 200;
+        std::string body;
+
+        const std::string prefix = "/user/";
+        if (method != "GET" || target.rfind(prefix, 0) != 0)
+        {
+            status = 404;
+            body = R"({"error":"Not found"})";
+        }
+        else if (Roll(m_HttpRandom, m_Script.httpErrorRate))
+        {
+            status = 503;
+            body = R"({"error":"Scripted users-rest error"})";
+        }
+        else
+        {
+            Json user = {
+                    {"uid", target.substr(prefix.size())},
+                    {"latestVersion", m_Script.latestVersion}
+            };
+            body = user.dump();
+        }
+
+        std::stringstream response;
+        response << "HTTP/1.1 " << status << (status == 200 ? " OK" : " Error") << "\r\n"
+                 << "Content-Type: application/json\r\n"
+                 << "Content-Length: " << body.size() << "\r\n"
+                 << "Connection: close\r\n\r\n"
+                 << body;
+        return response.str();
+    }
+
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "MockScript.h"
+
+#include "SlippiAuth/Core.h"
+
+#include <asio.hpp>
+#include <enet/enet.h>
+
+#include <atomic>
+#include <random>
+
+namespace SlippiAuth {
+
+    // Speaks the create-ticket/get-ticket-resp protocol of mm.slippi.gg and serves /user/<uid>
+    class MockServer
+    {
+    public:
+        explicit MockServer(MockScript script);
+        ~MockServer();
+
+        void Run();
+        void Stop();
+    private:
+        struct Ticket
+        {
+            ENetPeer* peer;
+            std::string targetConnectCode;
+            uint32_t dueTime;
+            bool willError;
+        };
+
+        void OnReceive(ENetPeer* peer, const Json& message);
+        void OnDisconnect(ENetPeer* peer);
+        void SendDueTickets();
+        void ServiceOpponentHost();
+
+        void Send(ENetPeer* peer, const Json& message);
+        static bool Roll(std::mt19937& random, double probability);
+
+        void ServeHttp();
+        void AcceptHttp(asio::ip::tcp::acceptor& acceptor);
+        std::string HandleHttpRequest(const std::string& requestLine);
+    private:
+        MockScript m_Script;
+        // The HTTP thread has its own engine, both sides replay the same rolls for a seed
+        std::mt19937 m_Random;
+        std::mt19937 m_HttpRandom;
+
+        ENetHost* m_Host = nullptr;
+        ENetHost* m_OpponentHost = nullptr;
+        std::vector<Ticket> m_Tickets;
+
+        asio::io_context m_HttpContext;
+        std::thread m_HttpThread;
+        std::atomic<bool> m_Running = false;
+
+        // Stats, printed when the mock stops
+        uint64_t m_TicketCount = 0;
+        uint64_t m_MatchCount = 0;
+    };
+
+}
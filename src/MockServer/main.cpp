@@ -0,0 +1,13 @@
+#include "MockServer.h"
+
+int main(int argc, char** argv)
+{
+    // Init logs
+    SlippiAuth::Log::Init();
+
+    // Load the script, by default every ticket is matched after 1.5 to 2 seconds
+    SlippiAuth::MockScript script = argc > 1 ? SlippiAuth::MockScript::Load(argv[1]) : SlippiAuth::MockScript();
+
+    SlippiAuth::MockServer server(script);
+    server.Run();
+}
@@ -0,0 +1,314 @@
+#include "OutcomeReport.h"
+
+#include "SlippiAuth/Client/ClientCredentials.h"
+
+#include <bit>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+
+namespace SlippiAuth {
+
+    static const std::array<const char*, SearchPhaseCount> s_PhaseNames = {
+            "connect", "ticket", "matchmaking", "handshake"
+    };
+
+    OutcomeReportOptions OutcomeReportOptions::Parse(int argc, char** argv)
+    {
+        OutcomeReportOptions options;
+
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "--json")
+            {
+                options.json = true;
+                continue;
+            }
+
+            if (arg.rfind("--", 0) != 0)
+            {
+                options.path = arg;
+                continue;
+            }
+
+            if (i + 1 >= argc)
+            {
+                CORE_ERROR("Missing value for {}", arg);
+                break;
+            }
+
+            std::string value = argv[++i];
+            if (arg == "--from")
+                options.from = std::stoll(value);
+            else if (arg == "--to")
+                options.to = std::stoll(value);
+            else if (arg == "--clients")
+                options.clients = value;
+            else
+                CORE_WARN("Unknown option {}", arg);
+        }
+
+        return options;
+    }
+
+    void OutcomeStats::Add(const OutcomeRecord& record)
+    {
+        count++;
+
+        size_t outcome = (size_t)record.outcome;
+        if (outcome < OutcomeCount)
+            outcomes[outcome]++;
+
+        if (record.outcome == Outcome::Authenticated)
+            latenciesMs.Add((uint32_t)std::min<uint64_t>((uint64_t)record.queuedMs + record.searchMs, UINT32_MAX));
+    }
+
+    double OutcomeStats::SuccessRate() const
+    {
+        uint64_t answered = count - outcomes[(size_t)Outcome::Cancelled];
+        return answered > 0 ? (double)outcomes[(size_t)Outcome::Authenticated] / (double)answered : 0.0;
+    }
+
+    size_t LatencyHistogram::BucketOf(uint32_t ms)
+    {
+        if (ms < s_SubBuckets)
+            return ms;
+
+        // The highest bit picks the row, the next ones the bucket in the row
+        size_t exponent = 31 - (size_t)std::countl_zero(ms);
+        size_t subBucket = (ms >> (exponent - s_SubBucketBits)) & (s_SubBuckets - 1);
+        return (exponent - s_SubBucketBits + 1) * s_SubBuckets + subBucket;
+    }
+
+    uint32_t LatencyHistogram::ValueOf(size_t bucket)
+    {
+        if (bucket < s_SubBuckets)
+            return (uint32_t)bucket;
+
+        size_t exponent = bucket / s_SubBuckets + s_SubBucketBits - 1;
+        uint64_t shift = exponent - s_SubBucketBits;
+        uint64_t low = (uint64_t)(s_SubBuckets + bucket % s_SubBuckets) << shift;
+        return (uint32_t)(low + ((1ull << shift) - 1) / 2);
+    }
+
+    void LatencyHistogram::Add(uint32_t ms)
+    {
+        m_Counts[BucketOf(ms)]++;
+        m_Total++;
+    }
+
+    uint32_t LatencyHistogram::Percentile(double p) const
+    {
+        if (m_Total == 0)
+            return 0;
+
+        uint64_t rank = std::min((uint64_t)(p * (double)m_Total), m_Total - 1);
+        uint64_t seen = 0;
+        for (size_t bucket = 0; bucket < s_BucketCount; bucket++)
+        {
+            seen += m_Counts[bucket];
+            if (seen > rank)
+                return ValueOf(bucket);
+        }
+        return ValueOf(s_BucketCount - 1);
+    }
+
+    static std::string FormatHour(int64_t hour)
+    {
+        time_t time = (time_t)(hour * 3600);
+        std::tm utc{};
+        gmtime_r(&time, &utc);
+
+        char buffer[32];
+        std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:00", &utc);
+        return buffer;
+    }
+
+    OutcomeReport::OutcomeReport(OutcomeReportOptions options)
+        : m_Options(std::move(options))
+    {
+    }
+
+    void OutcomeReport::ReadClients()
+    {
+        std::ifstream file(m_Options.clients);
+        Json accounts = Json::parse(file, nullptr, false);
+        if (!accounts.is_array())
+        {
+            CORE_WARN("Cannot read the accounts of {}, bots are named by account key", m_Options.clients);
+            return;
+        }
+
+        for (const auto& account : accounts)
+        {
+            if (auto credentials = ClientCredentials::Parse(account))
+                m_AccountNames[OutcomeLog::AccountKey(credentials->uid)] = credentials->connectCode;
+        }
+    }
+
+    std::string OutcomeReport::FormatAccount(uint32_t accountKey) const
+    {
+        auto iter = m_AccountNames.find(accountKey);
+        return iter != m_AccountNames.end() ? iter->second : fmt::format("{:08x}", accountKey);
+    }
+
+    bool OutcomeReport::Read()
+    {
+        if (!m_Options.clients.empty())
+            ReadClients();
+
+        std::unique_ptr<FILE, decltype(&fclose)> file(fopen(m_Options.path.c_str(), "rb"), &fclose);
+        if (!file)
+        {
+            CORE_ERROR("Cannot open {}", m_Options.path);
+            return false;
+        }
+
+        OutcomeLogHeader header{};
+        if (fread(&header, sizeof(header), 1, file.get()) != 1 || header.magic != OutcomeLog::Magic ||
+            header.version != OutcomeLog::Version || header.recordSize != sizeof(OutcomeRecord))
+        {
+            CORE_ERROR("{} is not an outcome log of this version", m_Options.path);
+            return false;
+        }
+
+        // Read in large chunks, the log holds millions of records
+        std::vector<OutcomeRecord> chunk(65536);
+        size_t read;
+        while ((read = fread(chunk.data(), sizeof(OutcomeRecord), chunk.size(), file.get())) > 0)
+        {
+            for (size_t i = 0; i < read; i++)
+                Add(chunk[i]);
+        }
+
+        return true;
+    }
+
+    void OutcomeReport::Add(const OutcomeRecord& record)
+    {
+        int64_t seconds = record.time / 1000;
+        if ((m_Options.from && seconds < *m_Options.from) || (m_Options.to && seconds >= *m_Options.to))
+            return;
+
+        m_Records++;
+        m_Total.Add(record);
+        m_ByHour[seconds / 3600].Add(record);
+
+        // Outcomes decided by the pool belong to no bot
+        if (record.clientId != OutcomeLog::NoClient)
+            m_ByBot[record.accountKey].Add(record);
+
+        if (record.outcome == Outcome::Authenticated)
+        {
+            for (size_t i = 0; i < SearchPhaseCount; i++)
+                m_PhasesMs[i].Add(record.phaseMs[i]);
+        }
+    }
+
+    Json OutcomeReport::ToJson(const OutcomeStats& stats)
+    {
+        Json outcomes = Json::object();
+        for (size_t i = 1; i < OutcomeCount; i++)
+            outcomes[OutcomeName((Outcome)i)] = stats.outcomes[i];
+
+        return {
+                {"count", stats.count},
+                {"successRate", stats.SuccessRate()},
+                {"latencyMs", {
+                        {"p50", stats.Percentile(0.5)},
+                        {"p90", stats.Percentile(0.9)},
+                        {"p99", stats.Percentile(0.99)}
+                }},
+                {"outcomes", outcomes}
+        };
+    }
+
+    void OutcomeReport::PrintLine(const std::string& label, const OutcomeStats& stats)
+    {
+        std::cout << std::left << std::setw(18) << label
+                  << std::right << std::setw(10) << stats.count
+                  << std::setw(9) << std::fixed << std::setprecision(1) << stats.SuccessRate() * 100.0 << "%"
+                  << std::setw(10) << stats.Percentile(0.5)
+                  << std::setw(10) << stats.Percentile(0.9)
+                  << std::setw(10) << stats.Percentile(0.99) << "\n";
+    }
+
+    void OutcomeReport::Print()
+    {
+        if (m_Options.json)
+        {
+            Json phases = Json::object();
+            for (size_t i = 0; i < SearchPhaseCount; i++)
+            {
+                phases[s_PhaseNames[i]] = {
+                        {"p50", m_PhasesMs[i].Percentile(0.5)},
+                        {"p99", m_PhasesMs[i].Percentile(0.99)}
+                };
+            }
+
+            // Keyed by account, two accounts can share a connect code in clients.json
+            Json bots = Json::object();
+            for (auto& [accountKey, stats] : m_ByBot)
+            {
+                Json bot = ToJson(stats);
+                bot["name"] = FormatAccount(accountKey);
+                bots[fmt::format("{:08x}", accountKey)] = std::move(bot);
+            }
+
+            Json hours = Json::object();
+            for (auto& [hour, stats] : m_ByHour)
+                hours[FormatHour(hour)] = ToJson(stats);
+
+            Json report = {
+                    {"records", m_Records},
+                    {"total", ToJson(m_Total)},
+                    {"phasesMs", phases},
+                    {"bots", bots},
+                    {"hours", hours}
+            };
+
+            std::cout << report.dump(2) << std::endl;
+            return;
+        }
+
+        auto printHeader = [](const char* label)
+        {
+            std::cout << std::left << std::setw(18) << label << std::right << std::setw(10) << "requests"
+                      << std::setw(10) << "success" << std::setw(10) << "p50 ms" << std::setw(10) << "p90 ms"
+                      << std::setw(10) << "p99 ms" << "\n";
+        };
+
+        std::cout << "Records:  " << m_Records << "\n\n";
+
+        printHeader("");
+        PrintLine("total", m_Total);
+
+        std::cout << "\nOutcomes:\n";
+        for (size_t i = 1; i < OutcomeCount; i++)
+        {
+            if (m_Total.outcomes[i] > 0)
+                std::cout << "  " << std::left << std::setw(16) << OutcomeName((Outcome)i) << m_Total.outcomes[i] << "\n";
+        }
+
+        std::cout << "\nPhases of the authenticated searches:\n";
+        for (size_t i = 0; i < SearchPhaseCount; i++)
+        {
+            std::cout << "  " << std::left << std::setw(16) << s_PhaseNames[i]
+                      << "p50 " << m_PhasesMs[i].Percentile(0.5) << "ms, p99 " << m_PhasesMs[i].Percentile(0.99) << "ms\n";
+        }
+
+        std::cout << "\n";
+        printHeader("bot");
+        for (auto& [accountKey, stats] : m_ByBot)
+            PrintLine(FormatAccount(accountKey), stats);
+
+        std::cout << "\n";
+        printHeader("hour (UTC)");
+        for (auto& [hour, stats] : m_ByHour)
+            PrintLine(FormatHour(hour), stats);
+
+        std::cout << std::flush;
+    }
+
+}
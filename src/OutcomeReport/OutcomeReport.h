@@ -0,0 +1,93 @@
+#pragma once
+
+#include "SlippiAuth/Client/OutcomeLog.h"
+
+#include <map>
+#include <optional>
+#include <unordered_map>
+
+namespace SlippiAuth {
+
+    struct OutcomeReportOptions
+    {
+        std::string path = "outcomes.log";
+        // Unix seconds, records outside of the range are skipped
+        std::optional<int64_t> from;
+        std::optional<int64_t> to;
+        bool json = false;
+        // clients.json, to name the bots by connect code instead of account key
+        std::string clients;
+
+        static OutcomeReportOptions Parse(int argc, char** argv);
+    };
+
+    // Latencies in fixed buckets, so a group costs the same for a thousand records or millions.
+    // Exact below 16ms, then 16 buckets per power of two, within about 3% of the real value.
+    class LatencyHistogram
+    {
+    public:
+        void Add(uint32_t ms);
+        [[nodiscard]] uint32_t Percentile(double p) const;
+    private:
+        static size_t BucketOf(uint32_t ms);
+        // Middle of the values the bucket holds
+        static uint32_t ValueOf(size_t bucket);
+    private:
+        static constexpr size_t s_SubBucketBits = 4;
+        static constexpr size_t s_SubBuckets = 1 << s_SubBucketBits;
+        // The exact values, then one row per power of two from 2^4 to 2^31
+        static constexpr size_t s_BucketCount = (32 - s_SubBucketBits + 1) * s_SubBuckets;
+
+        std::array<uint64_t, s_BucketCount> m_Counts{};
+        uint64_t m_Total = 0;
+    };
+
+    // Counts and latencies of a group of outcomes
+    struct OutcomeStats
+    {
+        uint64_t count = 0;
+        std::array<uint64_t, OutcomeCount> outcomes{};
+        // Queue to authenticated, of the authenticated requests only
+        LatencyHistogram latenciesMs;
+
+        void Add(const OutcomeRecord& record);
+
+        // Authenticated out of the requests the users did not cancel
+        [[nodiscard]] double SuccessRate() const;
+        [[nodiscard]] uint32_t Percentile(double p) const
+        {
+            return latenciesMs.Percentile(p);
+        }
+    };
+
+    // Success rates and latency percentiles per bot and per hour, read from an outcome log
+    class OutcomeReport
+    {
+    public:
+        explicit OutcomeReport(OutcomeReportOptions options);
+
+        // False if the file is missing or not an outcome log
+        bool Read();
+        void Print();
+    private:
+        void Add(const OutcomeRecord& record);
+        void ReadClients();
+        // Connect code of the account if known, its key in hex otherwise
+        std::string FormatAccount(uint32_t accountKey) const;
+
+        Json ToJson(const OutcomeStats& stats);
+        void PrintLine(const std::string& label, const OutcomeStats& stats);
+    private:
+        OutcomeReportOptions m_Options;
+        uint64_t m_Records = 0;
+
+        OutcomeStats m_Total;
+        // Keyed by account, the client ids change with the order of the accounts and the reloads
+        std::map<uint32_t, OutcomeStats> m_ByBot;
+        std::unordered_map<uint32_t, std::string> m_AccountNames;
+        // Hours since epoch, in UTC
+        std::map<int64_t, OutcomeStats> m_ByHour;
+        std::array<LatencyHistogram, SearchPhaseCount> m_PhasesMs;
+    };
+
+}
@@ -0,0 +1,13 @@
+#include "OutcomeReport.h"
+
+int main(int argc, char** argv)
+{
+    // Init logs
+    SlippiAuth::Log::Init();
+
+    SlippiAuth::OutcomeReport report(SlippiAuth::OutcomeReportOptions::Parse(argc, argv));
+    if (!report.Read())
+        return 1;
+
+    report.Print();
+}
@@ -0,0 +1,419 @@
+#include "SimulatedNetwork.h"
+
+#include "SlippiAuth/Client/PortAllocator.h"
+
+namespace SlippiAuth {
+
+    thread_local SimulatedNetwork::Participant* SimulatedNetwork::s_Current = nullptr;
+
+    SimulatedNetwork::SimulatedNetwork(MockScript script, uint32_t latency)
+        : m_Script(std::move(script)),
+        m_Latency(latency),
+        m_Random(m_Script.seed)
+    {
+        s_Current = &m_Driver;
+        m_Active = &m_Driver;
+    }
+
+    SimulatedNetwork::~SimulatedNetwork()
+    {
+        JoinFinished();
+
+        if (!m_Workers.empty())
+            CORE_ERROR("{} simulated threads are still running", m_Workers.size());
+
+        for (auto& worker : m_Workers)
+            worker->thread.detach();
+    }
+
+    uint32_t SimulatedNetwork::Milliseconds()
+    {
+        return (uint32_t)m_Time;
+    }
+
+    std::chrono::steady_clock::time_point SimulatedNetwork::Now()
+    {
+        return m_Start + std::chrono::milliseconds(m_Time);
+    }
+
+    bool SimulatedNetwork::Resolve(const std::string& hostName, ENetAddress& address)
+    {
+        // Every host is simulated
+        address.host = 0x0100007F;
+        address.port = 0;
+        return true;
+    }
+
+    std::unique_ptr<NetSession> SimulatedNetwork::Open(uint16_t port, size_t peerCount)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return std::make_unique<SimulatedSession>(*this, m_NextSessionId++);
+    }
+
+    std::future<cpr::Response> SimulatedNetwork::HttpGet(const std::string& url)
+    {
+        cpr::Response response;
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (Roll(m_Script.httpErrorRate))
+            {
+                response.status_code = 503;
+                response.text = R"({"error":"Scripted users-rest error"})";
+                response.error.message = "Scripted users-rest error";
+            }
+            else
+            {
+                response.status_code = 200;
+                response.text = Json({{"latestVersion", m_Script.latestVersion}}).dump();
+            }
+        }
+
+        std::promise<cpr::Response> promise;
+        promise.set_value(std::move(response));
+        return promise.get_future();
+    }
+
+    void SimulatedNetwork::Spawn(std::function<void()> job)
+    {
+        JoinFinished();
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        Worker* worker = m_Workers.emplace_back(std::make_unique<Worker>()).get();
+        WakeAfter(0, worker->participant);
+
+        worker->thread = std::thread([this, worker, job = std::move(job)]()
+        {
+            s_Current = &worker->participant;
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                worker->participant.turn.wait(lock, [&]() { return m_Active == &worker->participant; });
+            }
+
+            job();
+
+            // Give the turn away for good
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Finished.push_back(worker);
+            m_Active = nullptr;
+            Advance();
+        });
+    }
+
+    void SimulatedNetwork::SleepUntil(uint64_t time)
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        if (time <= m_Time)
+            return;
+
+        WakeAfter(time - m_Time, m_Driver);
+        Yield(lock);
+    }
+
+    void SimulatedNetwork::RunUntilIdle()
+    {
+        {
+            // The driver gets the turn back once no timer is left
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            Yield(lock);
+        }
+
+        JoinFinished();
+    }
+
+    void SimulatedNetwork::Schedule(uint64_t delay, std::function<void()> action)
+    {
+        m_Timers.push({m_Time + delay, m_NextSequence++, std::move(action)});
+    }
+
+    void SimulatedNetwork::WakeAfter(uint64_t delay, Participant& participant)
+    {
+        Schedule(delay, [this, &participant, generation = participant.generation]()
+        {
+            // Already woken up by a packet
+            if (participant.generation == generation)
+                Activate(participant);
+        });
+    }
+
+    void SimulatedNetwork::Activate(Participant& participant)
+    {
+        participant.generation++;
+        m_Active = &participant;
+        participant.turn.notify_one();
+    }
+
+    void SimulatedNetwork::Yield(std::unique_lock<std::mutex>& lock)
+    {
+        Participant& self = *s_Current;
+
+        m_Active = nullptr;
+        Advance();
+
+        self.turn.wait(lock, [&]() { return m_Active == &self; });
+    }
+
+    void SimulatedNetwork::Advance()
+    {
+        while (m_Active == nullptr)
+        {
+            if (m_Timers.empty())
+            {
+                Activate(m_Driver);
+                break;
+            }
+
+            // Stale wake-ups still move the clock, nothing is scheduled before them anyway
+            Timer timer = std::move(const_cast<Timer&>(m_Timers.top()));
+            m_Timers.pop();
+
+            m_Time = std::max(m_Time, timer.time);
+            timer.action();
+        }
+    }
+
+    void SimulatedNetwork::JoinFinished()
+    {
+        std::vector<std::unique_ptr<Worker>> finished;
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            for (Worker* worker : m_Finished)
+            {
+                auto iter = std::find_if(m_Workers.begin(), m_Workers.end(), [worker](const auto& running)
+                {
+                    return running.get() == worker;
+                });
+
+                finished.push_back(std::move(*iter));
+                m_Workers.erase(iter);
+            }
+            m_Finished.clear();
+        }
+
+        for (auto& worker : finished)
+            worker->thread.join();
+    }
+
+    void SimulatedNetwork::OnServerMessage(uint64_t sessionId, uint64_t epoch, const std::string& payload)
+    {
+        Json message;
+        try
+        {
+            message = Json::parse(payload);
+        }
+        catch (const Json::exception& e)
+        {
+            CORE_WARN("Invalid message from a client: {}", e.what());
+            return;
+        }
+
+        // Same answers as the mock server
+        if (message.value("type", "") != "create-ticket")
+        {
+            Deliver(m_Latency, sessionId, NetPeer::Server, epoch, ENET_EVENT_TYPE_RECEIVE,
+                    Json({{"type", "unknown"}, {"error", "Unsupported message"}}).dump());
+            return;
+        }
+
+        if (Roll(m_Script.createErrorRate))
+        {
+            Deliver(m_Latency, sessionId, NetPeer::Server, epoch, ENET_EVENT_TYPE_RECEIVE,
+                    Json({{"type", "create-ticket-resp"}, {"error", "Scripted create-ticket error"}}).dump());
+            return;
+        }
+
+        std::string targetConnectCode;
+        for (auto& byte : message["search"]["connectCode"])
+            targetConnectCode.push_back((char)byte.get<int>());
+
+        Deliver(m_Latency, sessionId, NetPeer::Server, epoch, ENET_EVENT_TYPE_RECEIVE,
+                Json({{"type", "create-ticket-resp"}}).dump());
+
+        if (Roll(m_Script.noMatchRate))
+            return;
+
+        std::uniform_int_distribution<uint32_t> jitter(0, m_Script.matchJitter);
+        uint64_t matchDelay = m_Script.matchDelay + jitter(m_Random);
+
+        Json response;
+        if (Roll(m_Script.ticketErrorRate))
+        {
+            response = {
+                    {"type", "get-ticket-resp"},
+                    {"error", "Scripted get-ticket error"},
+                    {"latestVersion", m_Script.latestVersion}
+            };
+        }
+        else
+        {
+            std::string opponentAddress = m_Script.opponentIp + ":" + std::to_string(m_Script.opponentPort);
+            response = {
+                    {"type", "get-ticket-resp"},
+                    {"players", {
+                            {
+                                    {"connectCode", targetConnectCode},
+                                    {"displayName", "Mock"},
+                                    {"ipAddress", opponentAddress}
+                            }
+                    }}
+            };
+        }
+
+        // Dropped with the connection if the client left matchmaking meanwhile
+        Deliver(matchDelay + m_Latency, sessionId, NetPeer::Server, epoch, ENET_EVENT_TYPE_RECEIVE, response.dump());
+    }
+
+    void SimulatedNetwork::Deliver(uint64_t delay, uint64_t sessionId, NetPeer peer, uint64_t epoch,
+                                   ENetEventType type, std::string payload)
+    {
+        Schedule(delay, [=, this, payload = std::move(payload)]() mutable
+        {
+            auto iter = m_Sessions.find(sessionId);
+            if (iter == m_Sessions.end())
+                return;
+
+            SimulatedSession& session = *iter->second;
+            if (session.m_Peers[(size_t)peer].epoch != epoch)
+                return;
+
+            session.m_Inbox.push_back({type, peer, std::move(payload)});
+            if (session.m_Waiter)
+                Activate(*session.m_Waiter);
+        });
+    }
+
+    bool SimulatedNetwork::Roll(double probability)
+    {
+        return std::uniform_real_distribution<double>(0.0, 1.0)(m_Random) < probability;
+    }
+
+    SimulatedSession::SimulatedSession(SimulatedNetwork& network, uint64_t id)
+        : m_Network(network), m_Id(id)
+    {
+        m_Network.m_Sessions[m_Id] = this;
+    }
+
+    SimulatedSession::~SimulatedSession()
+    {
+        std::lock_guard<std::mutex> lock(m_Network.m_Mutex);
+        m_Network.m_Sessions.erase(m_Id);
+    }
+
+    bool SimulatedSession::Connect(NetPeer peer, const ENetAddress& address)
+    {
+        std::lock_guard<std::mutex> lock(m_Network.m_Mutex);
+
+        Forget(peer);
+        m_Peers[(size_t)peer].active = true;
+
+        // The opponent only answers if the script plays it
+        if (peer == NetPeer::Server || m_Network.m_Script.serveOpponent)
+        {
+            m_Network.Deliver(2 * m_Network.m_Latency, m_Id, peer, m_Peers[(size_t)peer].epoch,
+                              ENET_EVENT_TYPE_CONNECT);
+        }
+
+        return true;
+    }
+
+    bool SimulatedSession::HasPeer(NetPeer peer) const
+    {
+        return m_Peers[(size_t)peer].active;
+    }
+
+    void SimulatedSession::Send(NetPeer peer, const std::string& payload)
+    {
+        std::lock_guard<std::mutex> lock(m_Network.m_Mutex);
+
+        if (peer != NetPeer::Server || !m_Peers[(size_t)peer].active)
+            return;
+
+        m_Network.Schedule(m_Network.m_Latency, [network = &m_Network, id = m_Id,
+                                                 epoch = m_Peers[(size_t)peer].epoch, payload]()
+        {
+            network->OnServerMessage(id, epoch, payload);
+        });
+    }
+
+    int SimulatedSession::Service(NetEvent& event, uint32_t timeoutMs)
+    {
+        std::unique_lock<std::mutex> lock(m_Network.m_Mutex);
+
+        if (m_Inbox.empty() && timeoutMs > 0)
+        {
+            m_Waiter = SimulatedNetwork::s_Current;
+            m_Network.WakeAfter(timeoutMs, *m_Waiter);
+            m_Network.Yield(lock);
+            m_Waiter = nullptr;
+        }
+
+        return Pop(event);
+    }
+
+    int SimulatedSession::CheckEvents(NetEvent& event)
+    {
+        std::lock_guard<std::mutex> lock(m_Network.m_Mutex);
+        return Pop(event);
+    }
+
+    int SimulatedSession::Pop(NetEvent& event)
+    {
+        if (m_Inbox.empty())
+        {
+            event.type = ENET_EVENT_TYPE_NONE;
+            return 0;
+        }
+
+        event = std::move(m_Inbox.front());
+        m_Inbox.pop_front();
+
+        if (event.type == ENET_EVENT_TYPE_DISCONNECT)
+            Forget(event.peer);
+
+        return 1;
+    }
+
+    void SimulatedSession::Disconnect(NetPeer peer)
+    {
+        std::lock_guard<std::mutex> lock(m_Network.m_Mutex);
+
+        if (m_Peers[(size_t)peer].active)
+        {
+            m_Network.Deliver(2 * m_Network.m_Latency, m_Id, peer, m_Peers[(size_t)peer].epoch,
+                              ENET_EVENT_TYPE_DISCONNECT);
+        }
+    }
+
+    void SimulatedSession::DisconnectNow(NetPeer peer)
+    {
+        std::lock_guard<std::mutex> lock(m_Network.m_Mutex);
+        Forget(peer);
+    }
+
+    void SimulatedSession::Reset(NetPeer peer)
+    {
+        std::lock_guard<std::mutex> lock(m_Network.m_Mutex);
+        Forget(peer);
+    }
+
+    void SimulatedSession::HandOff(std::chrono::milliseconds timeout, uint16_t port)
+    {
+        // Nobody waits on the opponent side of the simulation
+        {
+            std::lock_guard<std::mutex> lock(m_Network.m_Mutex);
+            Forget(NetPeer::Server);
+            Forget(NetPeer::Opponent);
+        }
+
+        PortAllocator::Get().Release(port);
+    }
+
+    void SimulatedSession::Forget(NetPeer peer)
+    {
+        m_Peers[(size_t)peer].active = false;
+        m_Peers[(size_t)peer].epoch++;
+    }
+
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "MockServer/MockScript.h"
+#include "SlippiAuth/Client/Network.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <unordered_map>
+
+namespace SlippiAuth {
+
+    class SimulatedSession;
+
+    // Plays the matchmaking server of the script on virtual time.
+    // The threads of the simulation take turns: only one runs at a time and the others wait in a network
+    // call, the clock jumps straight to the next scheduled event. The same script and seed replay the same run.
+    class SimulatedNetwork : public Network
+    {
+    public:
+        // The thread creating the network holds the first turn, it drives the simulation.
+        // `latency` is the one way latency to every peer, in milliseconds.
+        SimulatedNetwork(MockScript script, uint32_t latency);
+        SimulatedNetwork(const SimulatedNetwork&) = delete;
+        ~SimulatedNetwork() override;
+
+        uint32_t Milliseconds() override;
+        std::chrono::steady_clock::time_point Now() override;
+
+        void Prefetch(const std::string& hostName) override {}
+        bool Resolve(const std::string& hostName, ENetAddress& address) override;
+
+        std::unique_ptr<NetSession> Open(uint16_t port, size_t peerCount) override;
+
+        std::future<cpr::Response> HttpGet(const std::string& url) override;
+
+        // Executor of the pool, the job gets its own thread and waits for its turn
+        void Spawn(std::function<void()> job);
+
+        // Let the other threads run until the virtual time reaches `time`
+        void SleepUntil(uint64_t time);
+        // Let the other threads run until nothing is scheduled anymore
+        void RunUntilIdle();
+
+        // Virtual milliseconds since the start of the simulation
+        [[nodiscard]] uint64_t GetTime() const
+        {
+            return m_Time;
+        }
+    private:
+        friend class SimulatedSession;
+
+        struct Participant
+        {
+            std::condition_variable turn;
+            // Bumped when woken up, so an older wake-up is ignored
+            uint64_t generation = 0;
+        };
+
+        // A thread running a job of the pool
+        struct Worker
+        {
+            Participant participant;
+            std::thread thread;
+        };
+
+        struct Timer
+        {
+            uint64_t time;
+            uint64_t sequence;
+            std::function<void()> action;
+
+            bool operator>(const Timer& other) const
+            {
+                return time != other.time ? time > other.time : sequence > other.sequence;
+            }
+        };
+
+        // All of them must be called with m_Mutex held
+        void Schedule(uint64_t delay, std::function<void()> action);
+        void WakeAfter(uint64_t delay, Participant& participant);
+        void Activate(Participant& participant);
+        // Hand the turn over and wait to get it back
+        void Yield(std::unique_lock<std::mutex>& lock);
+        // Run the timers until one of them gives the turn to a thread
+        void Advance();
+        // Must be called without m_Mutex, the finished workers may still be releasing it
+        void JoinFinished();
+
+        // The matchmaking server side
+        void OnServerMessage(uint64_t sessionId, uint64_t epoch, const std::string& payload);
+        // Hand an event to the session after the delay, unless the peer went away meanwhile
+        void Deliver(uint64_t delay, uint64_t sessionId, NetPeer peer, uint64_t epoch,
+                     ENetEventType type, std::string payload = {});
+        bool Roll(double probability);
+    private:
+        MockScript m_Script;
+        uint32_t m_Latency;
+        std::mt19937 m_Random;
+
+        std::mutex m_Mutex;
+        uint64_t m_Time = 0;
+        std::chrono::steady_clock::time_point m_Start = std::chrono::steady_clock::now();
+        std::priority_queue<Timer, std::vector<Timer>, std::greater<>> m_Timers;
+        uint64_t m_NextSequence = 0;
+
+        Participant* m_Active = nullptr;
+        Participant m_Driver;
+        std::vector<std::unique_ptr<Worker>> m_Workers;
+        std::vector<Worker*> m_Finished;
+
+        std::unordered_map<uint64_t, SimulatedSession*> m_Sessions;
+        uint64_t m_NextSessionId = 0;
+
+        static thread_local Participant* s_Current;
+    };
+
+    class SimulatedSession : public NetSession
+    {
+    public:
+        SimulatedSession(SimulatedNetwork& network, uint64_t id);
+        ~SimulatedSession() override;
+
+        bool Connect(NetPeer peer, const ENetAddress& address) override;
+        [[nodiscard]] bool HasPeer(NetPeer peer) const override;
+
+        void Send(NetPeer peer, const std::string& payload) override;
+        int Service(NetEvent& event, uint32_t timeoutMs) override;
+        int CheckEvents(NetEvent& event) override;
+
+        void Disconnect(NetPeer peer) override;
+        void DisconnectNow(NetPeer peer) override;
+        void Reset(NetPeer peer) override;
+
+        void HandOff(std::chrono::milliseconds timeout, uint16_t port) override;
+    private:
+        friend class SimulatedNetwork;
+
+        struct Peer
+        {
+            bool active = false;
+            // Bumped when the peer goes away, packets of an older epoch are dropped
+            uint64_t epoch = 0;
+        };
+
+        // Must be called with the network mutex held
+        void Forget(NetPeer peer);
+        int Pop(NetEvent& event);
+    private:
+        SimulatedNetwork& m_Network;
+        uint64_t m_Id;
+        std::array<Peer, 2> m_Peers{};
+        std::deque<NetEvent> m_Inbox;
+        // Thread waiting in Service
+        SimulatedNetwork::Participant* m_Waiter = nullptr;
+    };
+
+}
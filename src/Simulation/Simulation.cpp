@@ -0,0 +1,251 @@
+#include "Simulation.h"
+
+#include "SlippiAuth/AppConfig.h"
+#include "SlippiAuth/Client/ClientPool.h"
+#include "SlippiAuth/Server/Server.h"
+
+namespace SlippiAuth {
+
+    SimulationOptions SimulationOptions::Parse(int argc, char** argv)
+    {
+        SimulationOptions options;
+
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            if (arg == "--json")
+            {
+                options.json = true;
+                continue;
+            }
+
+            if (i + 1 >= argc)
+            {
+                CORE_ERROR("Missing value for {}", arg);
+                break;
+            }
+
+            std::string value = argv[++i];
+            if (arg == "--script")
+                options.script = value;
+            else if (arg == "--seed")
+                options.seed = std::stoul(value);
+            else if (arg == "--bots")
+                options.bots = std::max(std::stoul(value), 1ul);
+            else if (arg == "--requests")
+                options.requests = std::stoull(value);
+            else if (arg == "--rate")
+                options.rate = std::max(std::stod(value), 0.001);
+            else if (arg == "--high-share")
+                options.highShare = std::stod(value);
+            else if (arg == "--timeout")
+                options.timeout = std::stoul(value);
+            else if (arg == "--latency")
+                options.latency = std::stoul(value);
+            else if (arg == "--log-level")
+                options.logLevel = value;
+            else
+                CORE_WARN("Unknown option {}", arg);
+        }
+
+        return options;
+    }
+
+    static MockScript LoadScript(const SimulationOptions& options)
+    {
+        MockScript script = options.script.empty() ? MockScript() : MockScript::Load(options.script);
+        if (options.seed)
+            script.seed = *options.seed;
+        return script;
+    }
+
+    Simulation::Simulation(SimulationOptions options)
+        : m_Options(std::move(options)),
+        m_Script(LoadScript(m_Options)),
+        m_Network(m_Script, m_Options.latency),
+        m_Random(m_Script.seed ^ 0x9E3779B9u)
+    {
+    }
+
+    void Simulation::Run()
+    {
+        // Everything left on the wall clock or touching the disk is turned off
+        Json config = AppConfig::Get();
+        config["rateLimit"]["userRate"] = 0;
+        config["rateLimit"]["globalRate"] = 0;
+        config["ports"]["cooldown"] = 0;
+        config["journal"]["path"] = "";
+        config["outcomes"]["path"] = "";
+        config["client"]["hotReload"] = false;
+        // The health thread runs on the wall clock, out of the simulation.
+        // Waiting requests still time out whenever the pool schedules.
+        config["health"]["quarantineAfter"] = std::numeric_limits<uint32_t>::max();
+        config["scheduler"]["laneTimer"] = false;
+        AppConfig::Set(config);
+
+        Json accounts = Json::array();
+        for (uint32_t i = 0; i < m_Options.bots; i++)
+        {
+            accounts.push_back({
+                {"uid", "sim" + std::to_string(i)},
+                {"playKey", "playKey"},
+                {"connectCode", "SIM#" + std::to_string(i % 10000)}
+            });
+        }
+        ClientConfig::Set(accounts);
+
+        Server server(0);
+        ClientPool pool(m_Network, [this](std::function<void()> job)
+        {
+            m_Network.Spawn(std::move(job));
+        });
+
+        server.SetEventCallback([&pool](Event& e)
+        {
+            pool.OnEvent(e);
+        });
+
+        auto forward = [this, &server](Event& e)
+        {
+            OnEvent(e);
+            server.OnEvent(e);
+        };
+        pool.SetEventCallback(forward);
+        pool.SetClientEventCallback(forward);
+
+        auto start = std::chrono::steady_clock::now();
+
+        std::exponential_distribution<double> interval(m_Options.rate / 1000.0);
+        std::uniform_real_distribution<double> priority(0.0, 1.0);
+        double arrival = 0.0;
+
+        for (uint64_t discordId = 1; discordId <= m_Options.requests; discordId++)
+        {
+            arrival += interval(m_Random);
+            m_Network.SleepUntil((uint64_t)arrival);
+
+            Json request = {
+                    {"type", "queue"},
+                    {"userCode", "USER#" + std::to_string(discordId % 10000)},
+                    {"timeout", m_Options.timeout},
+                    {"discordId", discordId},
+                    {"priority", priority(m_Random) < m_Options.highShare ? "high" : "normal"}
+            };
+
+            m_InFlight[discordId] = m_Network.GetTime();
+            m_Sent++;
+
+            server.HandleMessage(request.dump(), [this, discordId](const std::string& payload)
+            {
+                // Only rejections are answered directly
+                Json reply = Json::parse(payload);
+                OnOutcome(discordId, reply.value("type", "unknown").c_str());
+            });
+        }
+
+        m_Network.RunUntilIdle();
+        m_WallTime = std::chrono::steady_clock::now() - start;
+    }
+
+    void Simulation::OnEvent(Event& e)
+    {
+        EventDispatcher dispatcher(e);
+        dispatcher.Dispatch<AuthenticatedEvent>([this](auto& e) { return OnOutcome(e.GetDiscordId(), "authenticated"); });
+        dispatcher.Dispatch<TimeoutEvent>([this](auto& e) { return OnOutcome(e.GetDiscordId(), "timeout"); });
+        dispatcher.Dispatch<SlippiErrorEvent>([this](auto& e) { return OnOutcome(e.GetDiscordId(), "slippiErr"); });
+        dispatcher.Dispatch<NoReadyClientEvent>([this](auto& e) { return OnOutcome(e.GetDiscordId(), "noReadyClient"); });
+        dispatcher.Dispatch<UpstreamDownEvent>([this](auto& e) { return OnOutcome(e.GetDiscordId(), "upstreamDown"); });
+        dispatcher.Dispatch<CancelledEvent>([this](auto& e) { return OnOutcome(e.GetDiscordId(), "cancelled"); });
+    }
+
+    bool Simulation::OnOutcome(uint64_t discordId, const char* type)
+    {
+        auto iter = m_InFlight.find(discordId);
+        if (iter == m_InFlight.end())
+            return false;
+
+        uint64_t now = m_Network.GetTime();
+        if (std::strcmp(type, "authenticated") == 0)
+            m_LatenciesMs.push_back((double)(now - iter->second));
+
+        m_Outcomes[type]++;
+        m_InFlight.erase(iter);
+        m_Completed++;
+
+        // FNV-1a over the time, the request and the outcome
+        auto mix = [this](const void* data, size_t size)
+        {
+            auto* bytes = static_cast<const uint8_t*>(data);
+            for (size_t i = 0; i < size; i++)
+            {
+                m_Digest ^= bytes[i];
+                m_Digest *= 1099511628211ull;
+            }
+        };
+        mix(&now, sizeof(now));
+        mix(&discordId, sizeof(discordId));
+        mix(type, std::strlen(type));
+
+        return false;
+    }
+
+    void Simulation::PrintReport() const
+    {
+        std::vector<double> latencies = m_LatenciesMs;
+        std::sort(latencies.begin(), latencies.end());
+
+        auto percentile = [&](double p)
+        {
+            if (latencies.empty())
+                return 0.0;
+
+            size_t index = std::min((size_t)(p * (double)latencies.size()), latencies.size() - 1);
+            return latencies[index];
+        };
+
+        double virtualSeconds = (double)m_Network.GetTime() / 1000.0;
+        std::chrono::duration<double> wallSeconds = m_WallTime;
+        double speed = wallSeconds.count() > 0 ? (double)m_Completed / wallSeconds.count() : 0.0;
+
+        std::stringstream digest;
+        digest << std::hex << std::setw(16) << std::setfill('0') << m_Digest;
+
+        if (m_Options.json)
+        {
+            Json report = {
+                    {"seed", m_Script.seed},
+                    {"requests", m_Sent},
+                    {"completed", m_Completed},
+                    {"virtualSeconds", virtualSeconds},
+                    {"wallSeconds", wallSeconds.count()},
+                    {"requestsPerWallSecond", speed},
+                    {"latencyMs", {
+                            {"p50", percentile(0.5)},
+                            {"p99", percentile(0.99)},
+                            {"p999", percentile(0.999)},
+                            {"max", latencies.empty() ? 0.0 : latencies.back()}
+                    }},
+                    {"outcomes", m_Outcomes},
+                    {"digest", digest.str()}
+            };
+
+            std::cout << report.dump(2) << std::endl;
+            return;
+        }
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << "Requests:    " << m_Sent << " sent, " << m_Completed << " completed in "
+                  << virtualSeconds << " virtual seconds\n"
+                  << "Simulation:  " << wallSeconds.count() << "s, " << speed << " req/s\n"
+                  << "Latency:     p50 " << percentile(0.5) << "ms, p99 " << percentile(0.99)
+                  << "ms, p999 " << percentile(0.999) << "ms\n"
+                  << "Digest:      " << digest.str() << " (seed " << m_Script.seed << ")\n"
+                  << "Outcomes:\n";
+
+        for (auto& [type, count] : m_Outcomes)
+            std::cout << "  " << std::left << std::setw(16) << type << count << "\n";
+
+        std::cout << std::flush;
+    }
+
+}
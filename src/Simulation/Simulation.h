@@ -0,0 +1,60 @@
+#pragma once
+
+#include "SimulatedNetwork.h"
+
+#include <map>
+#include <optional>
+#include <unordered_map>
+
+namespace SlippiAuth {
+
+    struct SimulationOptions
+    {
+        // Mock script of the matchmaking server, the default one otherwise
+        std::string script;
+        std::optional<uint32_t> seed;
+
+        uint32_t bots = 16;
+        uint64_t requests = 10000;
+        // Queue requests per virtual second, arriving as a Poisson process
+        double rate = 5.0;
+        // Share of the requests sent with the high priority
+        double highShare = 0.0;
+        uint32_t timeout = 10000;
+        // One way latency to the simulated peers, in milliseconds
+        uint32_t latency = 20;
+        std::string logLevel = "error";
+        bool json = false;
+
+        static SimulationOptions Parse(int argc, char** argv);
+    };
+
+    // Sends queue requests through the Server and the ClientPool, with every client on simulated network and time
+    class Simulation
+    {
+    public:
+        explicit Simulation(SimulationOptions options);
+
+        void Run();
+        void PrintReport() const;
+    private:
+        void OnEvent(Event& e);
+        bool OnOutcome(uint64_t discordId, const char* type);
+    private:
+        SimulationOptions m_Options;
+        MockScript m_Script;
+        SimulatedNetwork m_Network;
+        std::mt19937 m_Random;
+
+        std::unordered_map<uint64_t, uint64_t> m_InFlight;
+        uint64_t m_Sent = 0;
+        uint64_t m_Completed = 0;
+        std::vector<double> m_LatenciesMs;
+        std::map<std::string, uint64_t> m_Outcomes;
+        // Hash of every outcome in order, equal between two runs of the same seed
+        uint64_t m_Digest = 14695981039346656037ull;
+
+        std::chrono::steady_clock::duration m_WallTime{};
+    };
+
+}
@@ -0,0 +1,22 @@
+#include "Simulation.h"
+
+#include "SlippiAuth/AppConfig.h"
+
+int main(int argc, char** argv)
+{
+    SlippiAuth::SimulationOptions options = SlippiAuth::SimulationOptions::Parse(argc, argv);
+
+    // The scheduler settings of config.json apply to the simulated pool
+    SlippiAuth::AppConfig::Load("config.json");
+
+    // Init logs, thousands of searches per second are too many to print
+    SlippiAuth::Log::Init();
+    auto level = spdlog::level::from_str(options.logLevel);
+    SlippiAuth::Log::SetClientLevel(level);
+    SlippiAuth::Log::GetCoreLogger()->set_level(level);
+    SlippiAuth::Log::GetServerLogger()->set_level(level);
+
+    SlippiAuth::Simulation simulation(std::move(options));
+    simulation.Run();
+    simulation.PrintReport();
+}
@@ -0,0 +1,16 @@
+#include "AppConfig.h"
+
+namespace SlippiAuth {
+
+    void AppConfig::ILoad(const std::string& path)
+    {
+        // The app config is optional, every setting has a default
+        std::ifstream configJson(path);
+        if (!configJson.is_open())
+            return;
+
+        configJson >> m_Data;
+        configJson.close();
+    }
+
+}
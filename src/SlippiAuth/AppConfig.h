@@ -0,0 +1,45 @@
+#pragma once
+
+#include "SlippiAuth/Core.h"
+
+namespace SlippiAuth {
+
+    class AppConfig
+    {
+    public:
+        AppConfig(const AppConfig&) = delete;
+
+        static AppConfig& GetInstance()
+        {
+            static AppConfig s_Instance;
+            return s_Instance;
+        }
+
+        static void Load(const std::string& path) { GetInstance().ILoad(path); }
+        // Replace the settings without a file, for tools running the pool on their own
+        static void Set(Json data) { GetInstance().m_Data = std::move(data); }
+        static const Json& Get() { return GetInstance().IGet(); }
+
+        // Read a key of a section, falling back to the default if either is missing
+        template<typename T>
+        static T Value(const std::string& section, const std::string& key, const T& defaultValue)
+        {
+            const Json& data = Get();
+
+            auto sectionIter = data.find(section);
+            if (sectionIter == data.end() || !sectionIter->is_object())
+                return defaultValue;
+
+            return sectionIter->value(key, defaultValue);
+        }
+    private:
+        void ILoad(const std::string& path);
+        const Json& IGet() { return m_Data; }
+        AppConfig() = default;
+
+        Json m_Data = Json::object();
+
+        static AppConfig s_Instance;
+    };
+
+}
@@ -1,17 +1,20 @@
 #include "Application.h"
 
+#include "SlippiAuth/AppConfig.h"
+
 namespace SlippiAuth {
 
-    Application::Application() : m_Server(9002)
+    Application::Application() :
+        m_Server(
+            AppConfig::Value("server", "port", (uint16_t)9002),
+            AppConfig::Value<std::string>("server", "unixSocket", "")
+            )
     {
         // Bind all the events
-        for (auto& Client : m_ClientPool.GetClients())
+        m_ClientPool.SetClientEventCallback([this](auto&& event)
         {
-            Client.SetEventCallback([this](auto&& event)
-            {
-                m_Server.OnEvent(std::forward<decltype(event)>(event));
-            });
-        }
+            m_Server.OnEvent(std::forward<decltype(event)>(event));
+        });
 
         m_Server.SetEventCallback([this](auto&& event)
         {
@@ -22,6 +25,9 @@ namespace SlippiAuth {
         {
             m_Server.OnEvent(std::forward<decltype(event)>(event));
         });
+
+        // Answer the requests left by a crash now that the events reach the server
+        m_ClientPool.RecoverJournal();
     }
 
     Application::~Application() = default;
@@ -14,8 +14,9 @@ namespace SlippiAuth {
 
         void Run();
     private:
-        ClientPool m_ClientPool;
+        // Declared first so running clients can still report while the pool shuts down
         Server m_Server;
+        ClientPool m_ClientPool;
     };
 
 }
\ No newline at end of file
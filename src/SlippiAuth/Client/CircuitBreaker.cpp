@@ -0,0 +1,126 @@
+#include "CircuitBreaker.h"
+
+#include <algorithm>
+
+namespace SlippiAuth {
+
+    CircuitBreaker::CircuitBreaker(Network& network, uint32_t failureThreshold, uint32_t openTimeMs,
+                                   uint32_t maxOpenTimeMs, uint32_t probeTimeoutMs)
+        : m_Network(network),
+        m_FailureThreshold(std::max(failureThreshold, 1u)),
+        m_OpenTimeMs(openTimeMs),
+        m_BaseOpenTimeMs(openTimeMs),
+        m_MaxOpenTimeMs(std::max(maxOpenTimeMs, openTimeMs)),
+        m_ProbeTimeout(probeTimeoutMs) {}
+
+    uint32_t CircuitBreaker::Allow(uint64_t& probe)
+    {
+        probe = 0;
+        if (m_State.load(std::memory_order_relaxed) == CircuitState::Closed)
+            return 0;
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        auto now = m_Network.Now();
+
+        switch (m_State.load(std::memory_order_relaxed))
+        {
+            case CircuitState::Closed:
+                return 0;
+            case CircuitState::Open:
+            {
+                if (now < m_OpenUntil)
+                {
+                    auto retryAfter = std::chrono::duration_cast<std::chrono::milliseconds>(m_OpenUntil - now);
+                    return std::max(static_cast<uint32_t>(retryAfter.count()), 1u);
+                }
+
+                // This request becomes the probe
+                CORE_INFO("Probing the Slippi servers");
+                m_State = CircuitState::HalfOpen;
+                m_ProbeInFlight = true;
+                m_ProbeStart = now;
+                probe = ++m_ProbeId;
+                return 0;
+            }
+            case CircuitState::HalfOpen:
+            {
+                // Retry once the probe is known to be over, at the latest when it times out
+                if (m_ProbeInFlight && now - m_ProbeStart < m_ProbeTimeout)
+                {
+                    auto retryAfter = std::chrono::duration_cast<std::chrono::milliseconds>(m_ProbeStart + m_ProbeTimeout - now);
+                    return std::max(static_cast<uint32_t>(retryAfter.count()), 1u);
+                }
+
+                m_ProbeInFlight = true;
+                m_ProbeStart = now;
+                probe = ++m_ProbeId;
+                return 0;
+            }
+        }
+
+        return 0;
+    }
+
+    void CircuitBreaker::ReleaseProbe(uint64_t probe)
+    {
+        if (probe == 0)
+            return;
+
+        // Nothing to do if the probe reported back, or if it was already replaced
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_State == CircuitState::HalfOpen && m_ProbeInFlight && m_ProbeId == probe)
+            m_ProbeInFlight = false;
+    }
+
+    void CircuitBreaker::RecordSuccess()
+    {
+        m_ConsecutiveFailures = 0;
+        if (m_State.load(std::memory_order_relaxed) == CircuitState::Closed)
+            return;
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (m_State != CircuitState::Closed)
+        {
+            CORE_INFO("Slippi servers recovered, closing the circuit");
+            m_State = CircuitState::Closed;
+            m_OpenTimeMs = m_BaseOpenTimeMs;
+            m_ProbeInFlight = false;
+        }
+    }
+
+    void CircuitBreaker::RecordFailure()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        auto now = m_Network.Now();
+
+        switch (m_State.load(std::memory_order_relaxed))
+        {
+            case CircuitState::Closed:
+            {
+                if (++m_ConsecutiveFailures >= m_FailureThreshold)
+                    Open(now);
+                break;
+            }
+            case CircuitState::HalfOpen:
+            {
+                // The probe failed, back off further
+                m_OpenTimeMs = std::min(m_OpenTimeMs * 2, m_MaxOpenTimeMs);
+                Open(now);
+                break;
+            }
+            case CircuitState::Open:
+                // Requests started before the circuit opened
+                break;
+        }
+    }
+
+    void CircuitBreaker::Open(Clock::time_point now)
+    {
+        CORE_WARN("Slippi servers look down, failing requests fast for {}ms", m_OpenTimeMs);
+        m_State = CircuitState::Open;
+        m_OpenUntil = now + std::chrono::milliseconds(m_OpenTimeMs);
+        m_ProbeInFlight = false;
+        m_ConsecutiveFailures = 0;
+    }
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "SlippiAuth/Client/Network.h"
+#include "SlippiAuth/Core.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+namespace SlippiAuth {
+
+    enum class CircuitState
+    {
+        // Slippi is healthy, everything goes through
+        Closed,
+        // Slippi looks down, requests fail fast
+        Open,
+        // One probe request is allowed to check if Slippi recovered
+        HalfOpen,
+    };
+
+    // Shared by every client of the pool, fed with the outcome of the calls to the Slippi services
+    class CircuitBreaker
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // The windows are timed on the network clock, like the rest of the pool
+        CircuitBreaker(Network& network, uint32_t failureThreshold, uint32_t openTimeMs, uint32_t maxOpenTimeMs,
+                       uint32_t probeTimeoutMs);
+
+        // Returns 0 if the request can go through, otherwise the retry-after in milliseconds.
+        // `probe` is set to a non-zero id when the request is the one probing the servers.
+        uint32_t Allow(uint64_t& probe);
+        // The probe ended without reaching Slippi, the next request probes instead
+        void ReleaseProbe(uint64_t probe);
+
+        void RecordSuccess();
+        void RecordFailure();
+
+        [[nodiscard]] CircuitState GetState() const
+        {
+            return m_State.load(std::memory_order_relaxed);
+        }
+    private:
+        void Open(Clock::time_point now);
+    private:
+        Network& m_Network;
+
+        // Checked without the lock so a closed circuit costs a single load
+        std::atomic<CircuitState> m_State = CircuitState::Closed;
+
+        std::mutex m_Mutex;
+        std::atomic<uint32_t> m_ConsecutiveFailures = 0;
+        uint32_t m_FailureThreshold;
+
+        // Doubled after each failed probe, up to the max
+        uint32_t m_OpenTimeMs;
+        uint32_t m_BaseOpenTimeMs;
+        uint32_t m_MaxOpenTimeMs;
+        Clock::time_point m_OpenUntil{};
+
+        // A probe that never reports back is replaced after this long
+        std::chrono::milliseconds m_ProbeTimeout;
+        bool m_ProbeInFlight = false;
+        Clock::time_point m_ProbeStart{};
+        uint64_t m_ProbeId = 0;
+    };
+
+}
@@ -1,15 +1,65 @@
 #include "SlippiAuth/Client/Client.h"
 
+#include "SlippiAuth/AppConfig.h"
+#include "SlippiAuth/Client/OpponentHandshakeService.h"
+#include "SlippiAuth/Client/PortAllocator.h"
 #include "SlippiAuth/Events/ClientEvent.h"
 
-#include <cpr/cpr.h>
-
 namespace SlippiAuth {
 
-    Client::Client(uint16_t id) :
+    // The latest Slippi version is the same for every account, one users-rest lookup serves them all
+    class LatestVersionCache
+    {
+    public:
+        static LatestVersionCache& GetInstance()
+        {
+            static LatestVersionCache s_Instance;
+            return s_Instance;
+        }
+
+        bool Get(std::string& version, std::chrono::steady_clock::time_point now)
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (m_Version.empty() || now >= m_ExpiresAt)
+                return false;
+
+            version = m_Version;
+            return true;
+        }
+
+        void Set(const std::string& version, std::chrono::steady_clock::time_point now)
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Version = version;
+            m_ExpiresAt = now + m_Ttl;
+        }
+    private:
+        std::mutex m_Mutex;
+        std::string m_Version;
+        std::chrono::steady_clock::time_point m_ExpiresAt{};
+        std::chrono::milliseconds m_Ttl{AppConfig::Value("http", "versionCacheTtl", 60000u)};
+    };
+
+    // Top level string field of a Slippi message, empty when missing
+    static std::string_view StringField(const Json& msg, const char* key)
+    {
+        auto iter = msg.find(key);
+        if (iter == msg.end() || !iter->is_string())
+            return {};
+        return iter->get_ref<const std::string&>();
+    }
+
+    Client::Client(uint16_t id, ClientCredentials credentials, ClientContext& context) :
+        m_Context(context),
+        m_Ready(context.states.Ready(id)),
+        m_Recorder(AppConfig::Value("client", "flightRecorder", (size_t)64)),
         m_Id(id),
-        m_Config(ClientConfig::Get()[id]),
-        m_State(ProcessState::Idle) {}
+        m_State(context.states.State(id)),
+        m_Deadline(context.states.Deadline(id)),
+        m_Credentials(std::move(credentials))
+    {
+        SetReady(true);
+    }
 
     Client::~Client()
     {
@@ -18,15 +68,20 @@ namespace SlippiAuth {
 
     void Client::Start()
     {
-        m_State = ProcessState::Initializing;
+        SetState(ProcessState::Initializing);
         m_Searching = true;
 
-        uint32_t TimeoutTime = enet_time_get() + m_Timeout;
+        m_Deadline = m_Context.network.Milliseconds() + m_Timeout;
+        m_PhaseMs = {};
+        m_SearchStart = m_PhaseStart = m_Context.network.Now();
 
         while (m_Searching)
         {
-            if (TimeoutTime <= enet_time_get())
-                m_State = ProcessState::Timeout;
+            if (m_Deadline <= m_Context.network.Milliseconds())
+                SetState(ProcessState::Timeout);
+
+            if (m_CancelRequested)
+                SetState(ProcessState::Cancelled);
 
             switch (m_State)
             {
@@ -34,8 +89,12 @@ namespace SlippiAuth {
                 {
                     StartSearching();
 
-                    SearchingEvent clientSpawnEvent(m_DiscordId, m_Config["connectCode"], m_TargetConnectCode);
-                    m_EventCallback(clientSpawnEvent);
+                    if (m_State == ProcessState::Matchmaking)
+                    {
+                        SearchingEvent clientSpawnEvent(m_DiscordId, m_RequestId, m_Credentials.connectCode,
+                                                        m_TargetConnectCode);
+                        m_Context.eventCallback(clientSpawnEvent);
+                    }
 
                     break;
                 }
@@ -46,6 +105,8 @@ namespace SlippiAuth {
                 }
                 case ProcessState::ConnectionSuccess:
                 {
+                    EndPhase(SearchPhase::Matchmaking);
+
                     // Will clean the server connection
                     Disconnect();
 
@@ -56,52 +117,114 @@ namespace SlippiAuth {
                             m_Remote.host
                             );
 
-                    m_EventCallback(authenticatedEvent);
+                    m_Context.eventCallback(authenticatedEvent);
 
-                    HandleConnecting();
-                    // Will clean the opponent connection
-                    Disconnect();
+                    // The match identified the user, the handshake is a courtesy to the opponent
+                    switch (OpponentHandshakeService::GetMode())
+                    {
+                        case OpponentHandshake::Blocking:
+                            HandleConnecting();
+                            // Will clean the opponent connection
+                            Disconnect();
+                            break;
+                        case OpponentHandshake::Background:
+                            HandOffConnecting();
+                            break;
+                        case OpponentHandshake::Skip:
+                            break;
+                    }
 
+                    EndPhase(SearchPhase::Handshake);
+                    LogOutcome(Outcome::Authenticated);
                     m_Searching = false;
                     break;
                 }
                 case ProcessState::Timeout:
                 {
+                    m_Recorder.Dump(m_Id);
+
                     TimeoutEvent timeoutEvent(m_DiscordId, m_TargetConnectCode);
-                    m_EventCallback(timeoutEvent);
+                    m_Context.eventCallback(timeoutEvent);
 
                     Disconnect();
 
+                    LogOutcome(Outcome::Timeout);
+                    m_Searching = false;
+                    break;
+                }
+
+                case ProcessState::Cancelled:
+                {
+                    // Leaving right away drops the ticket on the server side
+                    DisconnectNow();
+
+                    CancelledEvent cancelledEvent(m_DiscordId, m_TargetConnectCode);
+                    m_Context.eventCallback(cancelledEvent);
+
+                    LogOutcome(Outcome::Cancelled);
                     m_Searching = false;
                     break;
                 }
 
                 case ProcessState::ErrorEncountered:
                     {
+                        m_Recorder.Dump(m_Id);
+
                         SlippiErrorEvent slippiErrorEvent(m_DiscordId, m_TargetConnectCode);
-                        m_EventCallback(slippiErrorEvent);
+                        m_Context.eventCallback(slippiErrorEvent);
                         Disconnect();
+                        LogOutcome(Outcome::SlippiError);
                         m_Searching = false;
                         break;
                     }
                     default:
-                        m_State = ProcessState::ErrorEncountered;
+                        SetState(ProcessState::ErrorEncountered);
                 }
         }
 
-        m_State = ProcessState::Idle;
-        m_Ready = true;
+        ReleasePort();
+        SetState(ProcessState::Idle);
     }
 
-    void Client::SendMessage(const Json& msg)
+    bool Client::Validate()
+    {
+        // Search for ourselves, nobody will ever match
+        m_TargetConnectCode = m_Credentials.connectCode;
+        m_StartedAt = std::chrono::steady_clock::now();
+        m_Recorder.Reset();
+        SetState(ProcessState::Initializing);
+        m_CancelRequested = false;
+
+        StartSearching();
+
+        // Errors about the account come with the first ticket update
+        if (m_State == ProcessState::Matchmaking)
+            HandleSearching();
+
+        bool valid = m_State == ProcessState::Matchmaking;
+
+        Disconnect();
+        ReleasePort();
+        SetState(ProcessState::Idle);
+
+        return valid;
+    }
+
+    void Client::ReleasePort()
     {
-        enet_uint32 flags = ENET_PACKET_FLAG_RELIABLE;
-        uint8_t channelId = 0;
+        if (m_HostPort != 0)
+        {
+            PortAllocator::Get().Release(m_HostPort);
+            m_HostPort = 0;
+        }
+    }
 
+    void Client::SendMessage(const Json& msg)
+    {
         std::string msgContents = msg.dump();
+        m_Recorder.RecordMessage(FlightEvent::Sent, StringField(msg, "type"), msgContents.size());
 
-        ENetPacket* epac = enet_packet_create(msgContents.c_str(), msgContents.length(), flags);
-        enet_peer_send(m_Server, channelId, epac);
+        m_Session->Send(NetPeer::Server, msgContents);
     }
 
     int Client::ReceiveMessage(Json &msg, int timeoutMs)
@@ -115,143 +238,209 @@ namespace SlippiAuth {
         // This is not a perfect way to timeout but hopefully it's close enough?
         int maxAttempts = timeoutMs / hostServiceTimeoutMs;
 
-        for (int i = 0; i < maxAttempts; i++)
+        for (int i = 0; i < maxAttempts && !m_CancelRequested; i++)
         {
-            ENetEvent netEvent;
-            int net = enet_host_service(m_Client, &netEvent, hostServiceTimeoutMs);
-            if (net <= 0)
-                continue;
-
-            switch (netEvent.type)
+            if (m_Pending.empty())
             {
-                case ENET_EVENT_TYPE_RECEIVE:
+                NetEvent netEvent;
+                int net = ServiceHost(netEvent, hostServiceTimeoutMs);
+                if (net <= 0)
+                    continue;
+
+                // Take everything the wakeup brought in, one socket read for the whole batch
+                do
                 {
+                    QueuePending(std::move(netEvent));
+                } while (CheckEvents(netEvent) > 0);
 
-                    std::vector<uint8_t> buf;
-                    buf.insert(buf.end(), netEvent.packet->data, netEvent.packet->data + netEvent.packet->dataLength);
+                // Nothing for the matchmaking loop, keep waiting
+                if (m_Pending.empty())
+                    continue;
+            }
 
-                    std::string str(buf.begin(), buf.end());
-                    msg = Json::parse(str);
+            NetEvent netEvent = std::move(m_Pending.front());
+            m_Pending.pop_front();
 
-                    enet_packet_destroy(netEvent.packet);
-                    return 0;
-                }
-                case ENET_EVENT_TYPE_DISCONNECT:
-                    // Return -2 code to indicate we have lost connection to the server
-                    return -2;
-                default:
-                    return -1;
-            }
+            // Return -2 code to indicate we have lost connection to the server
+            if (netEvent.type == ENET_EVENT_TYPE_DISCONNECT)
+                return -2;
+
+            msg = Json::parse(netEvent.payload);
+
+            m_Recorder.RecordMessage(FlightEvent::Received, StringField(msg, "type"), netEvent.payload.size());
+            std::string_view error = StringField(msg, "error");
+            if (!error.empty())
+                m_Recorder.RecordMessage(FlightEvent::Error, error, 0);
+
+            return 0;
         }
 
         return -1;
     }
 
-    void Client::DisconnectFromServer()
+    void Client::QueuePending(NetEvent&& event)
     {
-        enet_peer_disconnect(m_Server, 0);
+        if (event.peer != NetPeer::Server
+            || (event.type != ENET_EVENT_TYPE_RECEIVE && event.type != ENET_EVENT_TYPE_DISCONNECT))
+            return;
 
-        ENetEvent netEvent;
-        while (enet_host_service(m_Client, &netEvent, 3000) > 0)
+        // Nothing after a disconnect is read, the matchmaking loop stops there
+        if (!m_Pending.empty() && m_Pending.back().type == ENET_EVENT_TYPE_DISCONNECT)
+            return;
+
+        // The oldest ones can be the answer the search waits for, and a disconnect is never dropped
+        if (event.type == ENET_EVENT_TYPE_RECEIVE && m_Pending.size() >= s_MaxPending)
         {
-            switch (netEvent.type)
-            {
-            case ENET_EVENT_TYPE_RECEIVE:
-                enet_packet_destroy(netEvent.packet);
-                break;
-            case ENET_EVENT_TYPE_DISCONNECT:
-                m_Server = nullptr;
-                return;
-            default:
-                break;
-            }
+            CLIENT_WARN(m_Id, "Too many messages from the server, dropping the newest");
+            return;
         }
 
-        // Didn't disconnect gracefully force disconnect
-        enet_peer_reset(m_Server);
-        m_Server = nullptr;
+        m_Pending.push_back(std::move(event));
+    }
+
+    int Client::CheckEvents(NetEvent& event)
+    {
+        int result = m_Session->CheckEvents(event);
+        if (result > 0)
+            m_Recorder.RecordNetwork(result, (uint8_t)event.type, event.type == ENET_EVENT_TYPE_RECEIVE ? event.payload.size() : 0);
+
+        return result;
+    }
+
+    void Client::EndPhase(SearchPhase phase)
+    {
+        auto now = m_Context.network.Now();
+        m_PhaseMs[(size_t)phase] = (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(now - m_PhaseStart).count();
+        m_PhaseStart = now;
+    }
+
+    void Client::LogOutcome(Outcome outcome)
+    {
+        auto searched = std::chrono::duration_cast<std::chrono::milliseconds>(m_Context.network.Now() - m_SearchStart);
+        m_Context.outcomes.Append(outcome, m_Id, OutcomeLog::AccountKey(m_Credentials.uid), m_DiscordId,
+                                  m_TargetConnectCode, m_QueuedMs,
+                                  (uint32_t)searched.count(), m_PhaseMs);
+    }
+
+    int Client::ServiceHost(NetEvent& event, uint32_t timeoutMs)
+    {
+        SLIPPIAUTH_PROBE(net_wait, m_Id, m_DiscordId, timeoutMs, ElapsedMs());
+        auto start = std::chrono::steady_clock::now();
+
+        int result = m_Session->Service(event, timeoutMs);
+        m_Recorder.RecordNetwork(result, (uint8_t)event.type, event.type == ENET_EVENT_TYPE_RECEIVE ? event.payload.size() : 0);
+
+        [[maybe_unused]] auto waited = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start);
+        SLIPPIAUTH_PROBE(net_wake, m_Id, m_DiscordId, result, result > 0 ? (int)event.type : 0, waited.count());
+        return result;
+    }
+
+    void Client::DisconnectFromServer()
+    {
+        DisconnectPeer(NetPeer::Server);
     }
 
     void Client::DisconnectFromOpponent()
     {
-        enet_peer_disconnect(m_Opponent, 0);
+        DisconnectPeer(NetPeer::Opponent);
+    }
+
+    void Client::DisconnectPeer(NetPeer peer)
+    {
+        m_Session->Disconnect(peer);
 
-        ENetEvent netEvent;
-        while (enet_host_service(m_Client, &netEvent, 3000) > 0)
+        NetEvent netEvent;
+        while (ServiceHost(netEvent, 3000) > 0)
         {
-            switch (netEvent.type)
-            {
-            case ENET_EVENT_TYPE_RECEIVE:
-                enet_packet_destroy(netEvent.packet);
-                break;
-            case ENET_EVENT_TYPE_DISCONNECT:
-                m_Opponent = nullptr;
+            // The session forgets the peer once it acknowledged, received packets are dropped
+            if (!m_Session->HasPeer(peer))
                 return;
-            default:
-                break;
-            }
         }
 
         // Didn't disconnect gracefully force disconnect
-        enet_peer_reset(m_Opponent);
-        m_Opponent = nullptr;
+        m_Session->Reset(peer);
     }
 
     void Client::Disconnect()
     {
+        if (!m_Session)
+            return;
+
         // Disconnect from server
-        if (m_Server != nullptr)
+        if (m_Session->HasPeer(NetPeer::Server))
             DisconnectFromServer();
 
-        if (m_Opponent != nullptr)
+        if (m_Session->HasPeer(NetPeer::Opponent))
             DisconnectFromOpponent();
 
         // Destroy client
-        if (m_Client)
-        {
-            enet_host_destroy(m_Client);
-            m_Client = nullptr;
-        }
+        m_Session.reset();
+        m_Pending.clear();
+    }
+
+    void Client::DisconnectNow()
+    {
+        if (!m_Session)
+            return;
+
+        m_Session->DisconnectNow(NetPeer::Server);
+        m_Session->DisconnectNow(NetPeer::Opponent);
+        m_Session.reset();
+        m_Pending.clear();
     }
 
     void Client::StartSearching()
     {
-        // Set the latest version
-        cpr::AsyncResponse slippiApiRespFuture = cpr::GetAsync(
-                cpr::Url{m_SlippiApiBaseUrl + "/" + m_Config["uid"].get<std::string>()},
-                cpr::VerifySsl(false)
-                );
+        // Set the latest version, it is the same for every account so most searches skip users-rest
+        std::future<cpr::Response> slippiApiRespFuture;
+        if (!LatestVersionCache::GetInstance().Get(m_SlippiLatestVersion, m_Context.network.Now()))
+        {
+            slippiApiRespFuture = m_Context.network.HttpGet(m_Context.endpoints.apiBaseUrl + "/" + m_Credentials.uid);
+        }
 
+        // A port that cannot be bound is put aside, the next one is tried right away
+        ReleasePort();
         int retryCount = 0;
-        while (m_Client == nullptr && retryCount < 15)
+        while (m_Session == nullptr && retryCount < 15)
         {
-            m_HostPort = 41000 + m_Id;
-
-            ENetAddress clientAddr;
-            clientAddr.host = ENET_HOST_ANY;
-            clientAddr.port = m_HostPort;
+            m_HostPort = PortAllocator::Get().Acquire(m_Id);
+            if (m_HostPort == 0)
+            {
+                CLIENT_ERROR(m_Id, "No free port left");
+                break;
+            }
 
-            m_Client = enet_host_create(&clientAddr, 1, 3, 0, 0);
+            m_Session = m_Context.network.Open(m_HostPort, 1);
+            if (m_Session == nullptr)
+            {
+                PortAllocator::Get().Release(m_HostPort, true);
+                m_HostPort = 0;
+            }
             retryCount++;
         }
 
-        if (m_Client == nullptr)
+        if (m_Session == nullptr)
         {
-            m_State = ProcessState::ErrorEncountered;
+            SetState(ProcessState::ErrorEncountered);
             CLIENT_ERROR(m_Id, "Failed to create client");
             return;
         }
 
         ENetAddress addr;
-        enet_address_set_host(&addr, m_ServerHost.c_str());
-        addr.port = m_ServerPort;
-
-        m_Server = enet_host_connect(m_Client, &addr, 3, 0);
+        if (!m_Context.network.Resolve(m_Context.endpoints.matchmakingHost, addr))
+        {
+            m_Context.circuitBreaker.RecordFailure();
+            SetState(ProcessState::ErrorEncountered);
+            CLIENT_ERROR(m_Id, "Failed to resolve {}", m_Context.endpoints.matchmakingHost);
+            return;
+        }
+        addr.port = m_Context.endpoints.matchmakingPort;
 
-        if (m_Server == nullptr)
+        if (!m_Session->Connect(NetPeer::Server, addr))
         {
-            m_State = ProcessState::ErrorEncountered;
-            CLIENT_ERROR(m_Id, "Failed to start connection to {}:{}", m_ServerHost, m_ServerPort);
+            SetState(ProcessState::ErrorEncountered);
+            CLIENT_ERROR(m_Id, "Failed to start connection to {}:{}", m_Context.endpoints.matchmakingHost, m_Context.endpoints.matchmakingPort);
             return;
         }
 
@@ -260,77 +449,113 @@ namespace SlippiAuth {
 
         while(!connected)
         {
-            ENetEvent  netEvent;
-            int net = enet_host_service(m_Client, &netEvent, 500);
+            // Cancelled while connecting, Start will clean up
+            if (m_CancelRequested)
+                return;
+
+            NetEvent netEvent;
+            int net = ServiceHost(netEvent, 500);
             if (net <= 0 || netEvent.type != ENET_EVENT_TYPE_CONNECT)
             {
                 // Not connected yet, will retry
                 connectAttemptCount++;
                 if (connectAttemptCount >= 20)
                 {
-                    m_State = ProcessState::ErrorEncountered;
-                    CLIENT_ERROR(m_Id, "Failed to connect to {}:{}", m_ServerHost, m_ServerPort);
+                    m_Context.circuitBreaker.RecordFailure();
+                    SetState(ProcessState::ErrorEncountered);
+                    CLIENT_ERROR(m_Id, "Failed to connect to {}:{}", m_Context.endpoints.matchmakingHost, m_Context.endpoints.matchmakingPort);
                     return;
                 }
+                continue;
             }
 
             connected = true;
         }
 
+        EndPhase(SearchPhase::Connect);
+
         // Buffering the connect code
         std::vector<uint8_t> connectCodeBuf;
         connectCodeBuf.insert(connectCodeBuf.end(),  m_TargetConnectCode.begin(),
                 m_TargetConnectCode.end());
 
-        // Retrieve the response
-        cpr::Response slippiApiResp = slippiApiRespFuture.get();
-
-        if (slippiApiResp.status_code == 200)
-        {
-            Json responseJson = Json::parse(slippiApiResp.text);
-            m_SlippiLatestVersion = responseJson["latestVersion"];
-        }
-        else
+        // Retrieve the response, unless the version came from the cache
+        if (slippiApiRespFuture.valid())
         {
-            m_State = ProcessState::ErrorEncountered;
-            CLIENT_ERROR(m_Id, "{}", slippiApiResp.error.message);
-            return;
+            cpr::Response slippiApiResp = slippiApiRespFuture.get();
+
+            if (m_CancelRequested)
+                return;
+
+            if (slippiApiResp.status_code == 200)
+            {
+                Json responseJson = Json::parse(slippiApiResp.text);
+                m_SlippiLatestVersion = responseJson["latestVersion"];
+                LatestVersionCache::GetInstance().Set(m_SlippiLatestVersion, m_Context.network.Now());
+            }
+            else
+            {
+                // A client error means users-rest does not know this account
+                if (slippiApiResp.status_code >= 400 && slippiApiResp.status_code < 500)
+                    m_Health.RecordFailure();
+                else
+                    m_Context.circuitBreaker.RecordFailure();
+
+                SetState(ProcessState::ErrorEncountered);
+                CLIENT_ERROR(m_Id, "{}", slippiApiResp.error.message);
+                return;
+            }
         }
 
         Json request = {
                 {"type", "create-ticket"},
-                {"user", {{"uid", m_Config["uid"]}, {"playKey", m_Config["playKey"]}}},
+                {"user", {{"uid", m_Credentials.uid}, {"playKey", m_Credentials.playKey}}},
                 {"search", {{"mode", 2}, {"connectCode", connectCodeBuf}}},
                 {"appVersion", m_SlippiLatestVersion},
                 {"ipAddressLan", "127.0.0.1:" + std::to_string(m_HostPort)},
         };
 
         SendMessage(request);
+        uint32_t ticketStartTime = m_Context.network.Milliseconds();
 
         Json response;
         int rcvRes = ReceiveMessage(response, 5000);
         if (rcvRes != 0)
         {
-            m_State = ProcessState::ErrorEncountered;
+            if (m_CancelRequested)
+                return;
+
+            m_Context.circuitBreaker.RecordFailure();
+            SetState(ProcessState::ErrorEncountered);
             CLIENT_ERROR(m_Id, "Did not receive response from server for create-ticket");
             return;
         }
 
+        // The matchmaking server answered, it is up
+        m_Context.circuitBreaker.RecordSuccess();
+
         std::string respType = response["type"];
         if (respType != "create-ticket-resp")
         {
-            m_State = ProcessState::ErrorEncountered;
+            m_Health.RecordFailure();
+            SetState(ProcessState::ErrorEncountered);
             CLIENT_ERROR(m_Id, "Received incorrect response from create-ticket");
             CLIENT_ERROR(m_Id, "{}", response.dump());
+            return;
         }
 
         std::string err = response.value("error", "");
         if (err.length() > 0)
         {
+            m_Health.RecordFailure();
+            SetState(ProcessState::ErrorEncountered);
             CLIENT_ERROR(m_Id, "Received error from server for create-ticket: {}", err);
+            return;
         }
 
-        m_State = ProcessState::Matchmaking;
+        m_Health.RecordSuccess(m_Context.network.Milliseconds() - ticketStartTime);
+        EndPhase(SearchPhase::Ticket);
+        SetState(ProcessState::Matchmaking);
     }
 
     void Client::HandleSearching()
@@ -343,8 +568,9 @@ namespace SlippiAuth {
         else if (rcvRes != 0)
         {
             // Only other code is -2 meaning the server dies probably
+            m_Context.circuitBreaker.RecordFailure();
             CLIENT_ERROR(m_Id, "Lost connection to the mm server");
-            m_State = ProcessState::ErrorEncountered;
+            SetState(ProcessState::ErrorEncountered);
             return;
         }
 
@@ -352,7 +578,8 @@ namespace SlippiAuth {
         if (respType != "get-ticket-resp")
         {
             CLIENT_ERROR(m_Id, "Received incorrect response from ticket");
-            m_State = ProcessState::ErrorEncountered;
+            m_Health.RecordFailure();
+            SetState(ProcessState::ErrorEncountered);
             return;
         }
 
@@ -366,7 +593,8 @@ namespace SlippiAuth {
             }
 
             CLIENT_ERROR(m_Id, "Received error from the server for get ticket: {}", err);
-            m_State = ProcessState::ErrorEncountered;
+            m_Health.RecordFailure();
+            SetState(ProcessState::ErrorEncountered);
             return;
         }
 
@@ -374,7 +602,7 @@ namespace SlippiAuth {
         {
             if (player["connectCode"] == m_TargetConnectCode)
             {
-                m_State = ProcessState::ConnectionSuccess;
+                SetState(ProcessState::ConnectionSuccess);
 
                 std::string fullIpAddress = player["ipAddress"];
 
@@ -394,29 +622,58 @@ namespace SlippiAuth {
         }
     }
 
-    void Client::HandleConnecting()
+    bool Client::ConnectToOpponent(uint16_t localPort)
     {
         ENetAddress addr;
-        enet_address_set_host(&addr, m_Remote.host.c_str());
+        if (!m_Context.network.Resolve(m_Remote.host, addr))
+        {
+            CLIENT_ERROR(m_Id, "Failed to resolve opponent address {}", m_Remote.host);
+            return false;
+        }
         addr.port = m_Remote.port;
 
-        ENetAddress localaddr;
-        localaddr.host = ENET_HOST_ANY;
-        localaddr.port = m_HostPort;
+        m_Session = m_Context.network.Open(localPort, 10);
+        m_Pending.clear();
+        if (m_Session == nullptr)
+        {
+            CLIENT_ERROR(m_Id, "m_Session is NULL!");
+            return false;
+        }
 
-        m_Client = enet_host_create(&localaddr, 10, 3, 0, 0);
-        m_Opponent = enet_host_connect(m_Client, &addr, 3, 0);
+        if (!m_Session->Connect(NetPeer::Opponent, addr))
+        {
+            CLIENT_ERROR(m_Id, "Failed to start connection to the opponent");
+            return false;
+        }
 
-        if (m_Client == nullptr)
-            CLIENT_ERROR(m_Id, "m_Client is NULL!");
+        return true;
+    }
 
-        if (m_Opponent == nullptr)
-            CLIENT_ERROR(m_Id, "m_Opponent is NULL!");
+    void Client::HandOffConnecting()
+    {
+        // The user expects the port advertised to the matchmaking server. The service keeps it reserved
+        // until the handshake is over, the next search takes another one from the allocator.
+        if (ConnectToOpponent(m_HostPort))
+        {
+            m_Session->HandOff(std::chrono::milliseconds(7500), m_HostPort);
+            m_Session.reset();
+            m_HostPort = 0;
+        }
+        else
+        {
+            DisconnectNow();
+        }
+    }
+
+    void Client::HandleConnecting()
+    {
+        if (!ConnectToOpponent(m_HostPort))
+            return;
 
-        for (int i = 0; i < 15; i++)
+        for (int i = 0; i < 15 && !m_CancelRequested; i++)
         {
-            ENetEvent netEvent;
-            enet_host_service(m_Client, &netEvent, 500);
+            NetEvent netEvent;
+            ServiceHost(netEvent, 500);
 
             if (netEvent.type == ENET_EVENT_TYPE_CONNECT)
                 break;
@@ -1,27 +1,43 @@
 #pragma once
 
 #include "ClientConfig.h"
+#include "ClientCredentials.h"
+#include "ClientStateTable.h"
+#include "PoolStatus.h"
+#include "CircuitBreaker.h"
+#include "ClientHealth.h"
+#include "FlightRecorder.h"
+#include "Network.h"
+#include "OutcomeLog.h"
+#include "SlippiEndpoints.h"
 #include "SlippiAuth/Core.h"
+#include "SlippiAuth/Probes.h"
 
 #include <enet/enet.h>
 
+#include <atomic>
+#include <deque>
+
 namespace SlippiAuth
 {
 
-    enum class ProcessState
+    // Shared by every client of a pool
+    struct ClientContext
     {
-        Idle,
-        Initializing,
-        Matchmaking,
-        ConnectionSuccess,
-        ErrorEncountered,
-        Timeout,
+        const SlippiEndpoints& endpoints;
+        Network& network;
+        CircuitBreaker& circuitBreaker;
+        ClientStateTable& states;
+        PoolStatus& status;
+        OutcomeLog& outcomes;
+        EventCallbackFn eventCallback;
     };
 
     class Client
     {
     public:
-        explicit Client(uint16_t id);
+        // The slot of the client must exist in the state table of the context
+        Client(uint16_t id, ClientCredentials credentials, ClientContext& context);
 
         ~Client();
 
@@ -35,57 +51,193 @@ namespace SlippiAuth
             return m_Id;
         }
 
-        [[nodiscard]] Json& GetConfig()
+        [[nodiscard]] bool IsQuarantined() const
+        {
+            return m_Quarantined;
+        }
+
+        [[nodiscard]] const ClientHealth& GetHealth() const
+        {
+            return m_Health;
+        }
+
+        [[nodiscard]] uint64_t GetDiscordId() const
+        {
+            return m_DiscordId;
+        }
+
+        [[nodiscard]] const ClientCredentials& GetCredentials() const
+        {
+            return m_Credentials;
+        }
+
+        [[nodiscard]] bool IsRetired() const
         {
-            return m_Config;
+            return m_Retired;
         }
 
-        void PreStart(const std::string& connectCode, uint32_t timeout, uint64_t discordId)
+        void PreStart(const std::string& connectCode, uint32_t timeout, uint64_t discordId, uint64_t requestId,
+                      uint32_t queuedMs = 0)
         {
             m_Timeout = timeout;
+            m_QueuedMs = queuedMs;
             m_TargetConnectCode = connectCode;
             m_DiscordId = discordId;
-            m_Ready = false;
+            m_RequestId = requestId;
+            m_StartedAt = std::chrono::steady_clock::now();
+            m_Recorder.Reset();
+            SetReady(false);
+            m_CancelRequested = false;
         }
 
         void Start();
 
-        inline void SetEventCallback(const EventCallbackFn& callback)
+        // Create a ticket and watch it briefly to check the account still works
+        bool Validate();
+
+        // Abort the search at the next wait point, can be called from any thread
+        inline void Cancel()
+        {
+            m_CancelRequested = true;
+        }
+
+        // Put the client back in rotation, called by the pool once Start returns
+        inline void MarkReady()
+        {
+            SetReady(true);
+        }
+
+        // Keep a failing account out of rotation until it validates again, also restarts its probe wait
+        inline void Quarantine()
+        {
+            SetQuarantined(true);
+            m_QuarantinedAt = m_Context.network.Now();
+        }
+
+        [[nodiscard]] std::chrono::steady_clock::time_point GetQuarantinedAt() const
+        {
+            return m_QuarantinedAt;
+        }
+
+        inline void Release()
+        {
+            SetQuarantined(false);
+            m_Health.Reset();
+            SetReady(true);
+        }
+
+        // Take the account out of the pool, a running search still finishes
+        inline void Retire()
+        {
+            m_Retired = true;
+            SetQuarantined(false);
+            SetReady(false);
+        }
+
+        // Put the client back in rotation with new credentials, it must not be running
+        inline void Revive(ClientCredentials credentials)
         {
-            m_EventCallback = callback;
+            m_Credentials = std::move(credentials);
+            m_Retired = false;
+            Release();
         }
 
     private:
+        // Keep the pool status counters in step with the flags
+        inline void SetReady(bool ready)
+        {
+            if (m_Ready != ready)
+                m_Context.status.AddIdle(ready ? 1 : -1);
+            m_Ready = ready;
+        }
+
+        inline void SetQuarantined(bool quarantined)
+        {
+            if (m_Quarantined != quarantined)
+                m_Context.status.AddQuarantined(quarantined ? 1 : -1);
+            m_Quarantined = quarantined;
+        }
+
+        inline void SetState(ProcessState state)
+        {
+            ProcessState previous = m_State.exchange(state);
+            m_Context.status.OnStateChange(previous, state);
+            m_Recorder.RecordState(previous, state);
+            SLIPPIAUTH_PROBE(state, m_Id, m_DiscordId, (int)previous, (int)state, ElapsedMs());
+        }
+
+        // Time since the request was handed to the client
+        [[nodiscard]] inline int64_t ElapsedMs() const
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - m_StartedAt).count();
+        }
+
+        // Close the current phase of the search and start the next one
+        void EndPhase(SearchPhase phase);
+        void LogOutcome(Outcome outcome);
+
+        // NetSession::Service with the net_wait and net_wake probes around it
+        int ServiceHost(NetEvent& event, uint32_t timeoutMs);
+
+        // Events already received without waiting, recorded like ServiceHost
+        int CheckEvents(NetEvent& event);
+
         void SendMessage(const Json& msg);
+        // Hands out the queued server messages first, then drains a whole batch per wakeup
         int ReceiveMessage(Json& msg, int timeoutMs);
+        // Keep the messages and disconnection of the server, drop the rest
+        void QueuePending(NetEvent&& event);
 
         void Disconnect();
+        // Drop every connection without waiting for the peers
+        void DisconnectNow();
         void DisconnectFromServer();
         void DisconnectFromOpponent();
+        // Wait for the peer to acknowledge, then drop it anyway
+        void DisconnectPeer(NetPeer peer);
 
         void StartSearching();
+        // Give the host port back to the allocator once the search is over
+        void ReleasePort();
         void HandleSearching();
         void HandleConnecting();
+        // Start the opponent handshake and let the background service finish it
+        void HandOffConnecting();
+        bool ConnectToOpponent(uint16_t localPort);
 
     private:
-        bool m_Ready = true;
+        ClientContext& m_Context;
+
+        bool& m_Ready;
+        bool m_Quarantined = false;
+        std::chrono::steady_clock::time_point m_QuarantinedAt{};
+        bool m_Retired = false;
+
+        ClientHealth m_Health;
+        FlightRecorder m_Recorder;
 
         uint16_t m_Id;
 
         // Connect code the client has to connect to
         std::string m_TargetConnectCode;
 
-        ProcessState m_State;
+        std::atomic<ProcessState>& m_State;
+        std::atomic<uint32_t>& m_Deadline;
 
-        const std::string m_SlippiApiBaseUrl = "https://users-rest-dot-slippi.uc.r.appspot.com/user";
         std::string m_SlippiLatestVersion{};
 
-        Json m_Config{};
+        ClientCredentials m_Credentials;
 
         bool m_Searching = false;
+        std::atomic<bool> m_CancelRequested = false;
+        std::chrono::steady_clock::time_point m_StartedAt{};
 
-        const std::string m_ServerHost = "mm.slippi.gg";
-        const uint16_t m_ServerPort = 43113;
+        // Timings of the last search, for the outcome log
+        uint32_t m_QueuedMs{};
+        SearchTimings m_PhaseMs{};
+        std::chrono::steady_clock::time_point m_SearchStart{};
+        std::chrono::steady_clock::time_point m_PhaseStart{};
 
         uint16_t m_HostPort{};
 
@@ -95,17 +247,19 @@ namespace SlippiAuth
             uint16_t port;
         } m_Remote{};
 
-        ENetHost* m_Client = nullptr;
-        ENetPeer* m_Server = nullptr;
-        ENetPeer* m_Opponent = nullptr;
-
-        EventCallbackFn m_EventCallback;
+        std::unique_ptr<NetSession> m_Session;
+        // Server events of the last batch, not handed to the matchmaking loop yet
+        std::deque<NetEvent> m_Pending;
+        // Messages over the limit are dropped, a disconnect is always kept
+        static constexpr size_t s_MaxPending = 32;
 
         // Timeout in seconds
         uint32_t m_Timeout{};
 
         // For codeman purposes
         uint64_t m_DiscordId{};
+        // Id of the request in the pool, sent with searching so the user can cancel this one only
+        uint64_t m_RequestId{};
 
         // For tournament purposes
         std::string m_UserName{};
@@ -4,10 +4,36 @@ namespace SlippiAuth {
 
     void ClientConfig::ILoad(const std::string& path)
     {
+        m_Path = path;
+
         // Read a JSON file
         std::ifstream clientsJson(path);
         clientsJson >> m_Data;
         clientsJson.close();
     }
 
+    bool ClientConfig::IReload()
+    {
+        Json data;
+        try
+        {
+            std::ifstream clientsJson(m_Path);
+            clientsJson >> data;
+        }
+        catch (const Json::exception& e)
+        {
+            CORE_ERROR("Failed to reload {}: {}", m_Path, e.what());
+            return false;
+        }
+
+        if (!data.is_array())
+        {
+            CORE_ERROR("Failed to reload {}: expected an array of accounts", m_Path);
+            return false;
+        }
+
+        m_Data = std::move(data);
+        return true;
+    }
+
 }
\ No newline at end of file
@@ -16,13 +16,21 @@ namespace SlippiAuth {
         }
 
         static void Load(const std::string& path) { GetInstance().ILoad(path); }
+        // Read the file given to Load again, the previous accounts are kept if it is invalid.
+        // Only the config watcher calls it once the pool is running.
+        static bool Reload() { return GetInstance().IReload(); }
+        [[nodiscard]] static const std::string& GetPath() { return GetInstance().m_Path; }
+        // Replace the accounts without a file, for tools generating them
+        static void Set(Json data) { GetInstance().m_Data = std::move(data); }
         static const Json& Get() { return GetInstance().IGet(); }
     private:
         void ILoad(const std::string& path);
+        bool IReload();
         const Json& IGet() { return m_Data; }
         ClientConfig() = default;
 
         Json m_Data;
+        std::string m_Path;
 
         static ClientConfig s_Instance;
     };
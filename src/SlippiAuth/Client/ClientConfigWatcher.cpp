@@ -0,0 +1,122 @@
+#include "ClientConfigWatcher.h"
+
+#include "SlippiAuth/Client/ClientConfig.h"
+
+#include <filesystem>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace SlippiAuth {
+
+    ClientConfigWatcher::ClientConfigWatcher(std::string path, ReloadFn onReload)
+        : m_Path(std::move(path)), m_OnReload(std::move(onReload))
+    {
+#ifdef __linux__
+        // Watch the directory, editors often replace the file instead of writing to it
+        auto directory = std::filesystem::path(m_Path).parent_path();
+        if (directory.empty())
+            directory = ".";
+
+        m_InotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_InotifyFd < 0 ||
+            inotify_add_watch(m_InotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0)
+        {
+            CORE_ERROR("Cannot watch {} for changes, falling back to polling", m_Path);
+            if (m_InotifyFd >= 0)
+                close(m_InotifyFd);
+            m_InotifyFd = -1;
+        }
+#endif
+
+        m_Thread = std::thread([this]() { Run(); });
+    }
+
+    ClientConfigWatcher::~ClientConfigWatcher()
+    {
+        m_Stopping = true;
+        m_Thread.join();
+
+#ifdef __linux__
+        if (m_InotifyFd >= 0)
+            close(m_InotifyFd);
+#endif
+    }
+
+    void ClientConfigWatcher::Run()
+    {
+        CORE_INFO("Watching {} for account changes", m_Path);
+
+        while (WaitForChange())
+        {
+            if (!ClientConfig::Reload())
+                continue;
+
+            CORE_INFO("{} changed, reloading the accounts", m_Path);
+            m_OnReload(ClientConfig::Get());
+        }
+    }
+
+    bool ClientConfigWatcher::WaitForChange()
+    {
+#ifdef __linux__
+        if (m_InotifyFd >= 0)
+        {
+            auto fileName = std::filesystem::path(m_Path).filename().string();
+            bool changed = false;
+
+            while (!m_Stopping)
+            {
+                pollfd fd = {m_InotifyFd, POLLIN, 0};
+                int timeout = changed ? (int)s_Debounce.count() : s_PollTimeoutMs;
+                int ready = poll(&fd, 1, timeout);
+
+                // Nothing else happened during the debounce, the file is complete
+                if (ready == 0 && changed)
+                    return true;
+
+                if (ready <= 0)
+                    continue;
+
+                alignas(inotify_event) char buffer[4096];
+                ssize_t length;
+                while ((length = read(m_InotifyFd, buffer, sizeof(buffer))) > 0)
+                {
+                    for (char* ptr = buffer; ptr < buffer + length;)
+                    {
+                        auto* event = reinterpret_cast<inotify_event*>(ptr);
+                        if (event->len > 0 && fileName == event->name)
+                            changed = true;
+
+                        ptr += sizeof(inotify_event) + event->len;
+                    }
+                }
+            }
+
+            return false;
+        }
+#endif
+
+        // Compare the modification time when inotify is not available
+        std::error_code error;
+        auto lastWrite = std::filesystem::last_write_time(m_Path, error);
+
+        while (!m_Stopping)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(s_PollTimeoutMs));
+
+            auto write = std::filesystem::last_write_time(m_Path, error);
+            if (!error && write != lastWrite)
+            {
+                std::this_thread::sleep_for(s_Debounce);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+}
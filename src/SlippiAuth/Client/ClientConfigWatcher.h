@@ -0,0 +1,37 @@
+#pragma once
+
+#include "SlippiAuth/Core.h"
+
+#include <atomic>
+
+namespace SlippiAuth {
+
+    // Reloads the accounts file when it changes on disk and hands the new list to the pool
+    class ClientConfigWatcher
+    {
+    public:
+        using ReloadFn = std::function<void(const Json&)>;
+
+        ClientConfigWatcher(std::string path, ReloadFn onReload);
+        ClientConfigWatcher(const ClientConfigWatcher&) = delete;
+        ~ClientConfigWatcher();
+    private:
+        void Run();
+        // Blocks until the file changed, returns false once stopping
+        bool WaitForChange();
+    private:
+        std::string m_Path;
+        ReloadFn m_OnReload;
+
+        std::thread m_Thread;
+        std::atomic<bool> m_Stopping = false;
+
+        int m_InotifyFd = -1;
+
+        // Editors write a file in several steps, wait for the last one
+        static constexpr auto s_Debounce = std::chrono::milliseconds(200);
+        // How often the stop flag is checked
+        static constexpr int s_PollTimeoutMs = 500;
+    };
+
+}
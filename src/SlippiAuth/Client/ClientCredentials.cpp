@@ -0,0 +1,23 @@
+#include "ClientCredentials.h"
+
+namespace SlippiAuth {
+
+    std::optional<ClientCredentials> ClientCredentials::Parse(const Json& account)
+    {
+        for (const char* key : {"uid", "playKey", "connectCode"})
+        {
+            if (!account.contains(key) || !account[key].is_string())
+            {
+                CORE_ERROR("Ignoring an account without {}: {}", key, account.dump());
+                return std::nullopt;
+            }
+        }
+
+        return ClientCredentials{
+            account["uid"],
+            account["playKey"],
+            account["connectCode"]
+        };
+    }
+
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "SlippiAuth/Core.h"
+
+#include <optional>
+
+namespace SlippiAuth {
+
+    // Account of a bot, parsed once from clients.json
+    struct ClientCredentials
+    {
+        std::string uid;
+        std::string playKey;
+        std::string connectCode;
+
+        // Logs and returns nothing if a field is missing or not a string
+        static std::optional<ClientCredentials> Parse(const Json& account);
+
+        bool operator==(const ClientCredentials& other) const = default;
+    };
+
+}
@@ -0,0 +1,30 @@
+#include "ClientHealth.h"
+
+namespace SlippiAuth {
+
+    void ClientHealth::RecordSuccess(uint32_t ticketLatencyMs)
+    {
+        m_ErrorRate *= 1.0f - s_Alpha;
+        m_TicketLatencyMs += s_Alpha * ((float)ticketLatencyMs - m_TicketLatencyMs);
+        m_ConsecutiveFailures = 0;
+    }
+
+    void ClientHealth::RecordFailure()
+    {
+        m_ErrorRate += s_Alpha * (1.0f - m_ErrorRate);
+        m_ConsecutiveFailures++;
+    }
+
+    void ClientHealth::Reset()
+    {
+        m_ErrorRate = 0.0f;
+        m_TicketLatencyMs = 0.0f;
+        m_ConsecutiveFailures = 0;
+    }
+
+    float ClientHealth::GetScore() const
+    {
+        return (1.0f - m_ErrorRate) / (1.0f + m_TicketLatencyMs / s_ReferenceLatencyMs);
+    }
+
+}
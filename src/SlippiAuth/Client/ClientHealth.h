@@ -0,0 +1,44 @@
+#pragma once
+
+#include "SlippiAuth/Core.h"
+
+namespace SlippiAuth {
+
+    // Rolling health of a bot account, only touched by the thread running the client
+    // or by the pool while the client is not running
+    class ClientHealth
+    {
+    public:
+        void RecordSuccess(uint32_t ticketLatencyMs);
+        void RecordFailure();
+        void Reset();
+
+        // Between 0 and 1, higher is healthier
+        [[nodiscard]] float GetScore() const;
+
+        [[nodiscard]] uint32_t GetConsecutiveFailures() const
+        {
+            return m_ConsecutiveFailures;
+        }
+
+        [[nodiscard]] float GetErrorRate() const
+        {
+            return m_ErrorRate;
+        }
+
+        [[nodiscard]] float GetTicketLatency() const
+        {
+            return m_TicketLatencyMs;
+        }
+    private:
+        // Weight of the newest sample in the moving averages
+        static constexpr float s_Alpha = 0.2f;
+        // Ticket latency at which the score is halved
+        static constexpr float s_ReferenceLatencyMs = 1000.0f;
+
+        float m_ErrorRate = 0.0f;
+        float m_TicketLatencyMs = 0.0f;
+        uint32_t m_ConsecutiveFailures = 0;
+    };
+
+}
@@ -1,33 +1,112 @@
 #include "ClientPool.h"
 
+#include "SlippiAuth/AppConfig.h"
+#include "SlippiAuth/Events/ClientEvent.h"
 #include "SlippiAuth/Events/ClientPoolEvent.h"
+#include "SlippiAuth/Probes.h"
 
 namespace SlippiAuth {
 
-    ClientPool::ClientPool()
+    ClientPool::ClientPool(Network& network, Executor executor) :
+        m_Network(network),
+        m_Executor(std::move(executor)),
+        m_CircuitBreaker(
+            m_Network,
+            AppConfig::Value("circuitBreaker", "failureThreshold", 5u),
+            AppConfig::Value("circuitBreaker", "openTime", 2000u),
+            AppConfig::Value("circuitBreaker", "maxOpenTime", 60000u),
+            AppConfig::Value("circuitBreaker", "probeTimeout", 15000u)
+            ),
+        m_Outcomes(
+            AppConfig::Value<std::string>("outcomes", "path", "outcomes.log"),
+            AppConfig::Value("outcomes", "batchSize", (size_t)256),
+            std::chrono::milliseconds(AppConfig::Value("outcomes", "flushInterval", 1000u))
+            ),
+        m_Journal(
+            AppConfig::Value<std::string>("journal", "path", "requests.journal"),
+            AppConfig::Value("journal", "capacity", (size_t)4096),
+            std::chrono::milliseconds(AppConfig::Value("journal", "flushInterval", 10u))
+            )
     {
-        // Initialize ENet
-        if (enet_initialize() != 0)
+        // Resolve the matchmaking server before the first request needs it
+        m_Network.Prefetch(SlippiEndpoints::Get().matchmakingHost);
+
+        // Scheduler settings
+        std::string policy = AppConfig::Value<std::string>("scheduler", "policy", "strict");
+        m_Policy = policy == "weighted" ? SchedulerPolicy::WeightedFair : SchedulerPolicy::Strict;
+        m_LaneWeights[(size_t)QueuePriority::Normal] = std::max(AppConfig::Value("scheduler", "normalWeight", 1u), 1u);
+        m_LaneWeights[(size_t)QueuePriority::High] = std::max(AppConfig::Value("scheduler", "highWeight", 3u), 1u);
+        m_ReservedHighClients = AppConfig::Value("scheduler", "reservedHighClients", 0u);
+        m_MaxQueueDepth = AppConfig::Value("scheduler", "maxQueueDepth", (size_t)16);
+        m_LaneTimer = AppConfig::Value("scheduler", "laneTimer", true);
+        m_RecoveryMinRemaining = std::chrono::milliseconds(AppConfig::Value("journal", "minRemaining", 5000u));
+
+        const Json& accounts = ClientConfig::Get();
+        if (m_ReservedHighClients >= accounts.size() && !accounts.empty())
+        {
+            CORE_WARN("{} clients reserved for high priority out of {}, normal requests will never be served",
+                      m_ReservedHighClients, accounts.size());
+        }
+
+        // Health settings
+        m_QuarantineThreshold = std::max(AppConfig::Value("health", "quarantineAfter", 3u), 1u);
+        m_ProbeInterval = std::chrono::milliseconds(AppConfig::Value("health", "probeInterval", 300000u));
+
+        m_Threads.reserve(accounts.size());
+        for (const auto& account : accounts)
         {
-            CORE_ERROR("An error occurred while initializing ENet!");
+            if (auto credentials = ClientCredentials::Parse(account))
+                AddClient(std::move(*credentials));
         }
 
-        m_Clients.reserve(m_PoolSize);
-        m_Threads.reserve(m_PoolSize);
-        for (int i = 0; i < m_PoolSize; i++)
+        m_HealthThread = std::thread([this]() { RunHealthProbes(); });
+
+        // Accounts set without a file cannot be reloaded
+        if (!ClientConfig::GetPath().empty() && AppConfig::Value("client", "hotReload", true))
         {
-            m_Clients.emplace_back(i);
+            m_ConfigWatcher = std::make_unique<ClientConfigWatcher>(ClientConfig::GetPath(), [this](const Json& accounts)
+            {
+                Reload(accounts);
+            });
         }
     }
 
     ClientPool::~ClientPool()
     {
-        for (auto& thread : m_Threads)
+        m_ConfigWatcher.reset();
+
         {
-            if (thread.joinable())
-                thread.join();
-            else
-                CORE_ERROR("Cannot join thread");
+            std::lock_guard<std::mutex> lock(m_PoolMutex);
+            m_Stopping = true;
+
+            // Searches left after a drain timed out are abandoned
+            for (uint16_t id : m_BusyClients)
+                m_Clients[id].Cancel();
+        }
+        m_HealthCondition.notify_all();
+        m_HealthThread.join();
+
+        // A thread still dispatching what it scheduled before m_Stopping was set can start one more,
+        // take them out under the lock until none is left
+        while (true)
+        {
+            std::vector<std::thread> threads;
+            {
+                std::lock_guard<std::mutex> lock(m_ThreadMutex);
+                if (m_Threads.empty())
+                    break;
+
+                threads.swap(m_Threads);
+                m_FinishedThreads.clear();
+            }
+
+            for (auto& thread : threads)
+            {
+                if (thread.joinable())
+                    thread.join();
+                else
+                    CORE_ERROR("Cannot join thread");
+            }
         }
     }
 
@@ -37,63 +116,750 @@ namespace SlippiAuth {
 
         EventDispatcher dispatcher(e);
         dispatcher.Dispatch<QueueEvent>(BIND_EVENT_FN(ClientPool::OnQueue));
+        dispatcher.Dispatch<CancelEvent>(BIND_EVENT_FN(ClientPool::OnCancel));
+        dispatcher.Dispatch<StatusEvent>(BIND_EVENT_FN(ClientPool::OnStatus));
     }
 
     bool ClientPool::OnQueue(QueueEvent& e)
     {
-        StartClient(e.GetUserConnectCode(), e.GetTimeout(), e.GetDiscordId());
+        // Fail fast while the Slippi servers are down instead of tying up a client
+        uint64_t probe;
+        uint32_t retryAfter = m_CircuitBreaker.Allow(probe);
+        if (retryAfter > 0)
+        {
+            m_Outcomes.Append(Outcome::UpstreamDown, OutcomeLog::NoClient, 0, e.GetDiscordId(), e.GetUserConnectCode(), 0);
+
+            UpstreamDownEvent event(e.GetDiscordId(), e.GetUserConnectCode(), retryAfter);
+            m_EventCallback(event);
+            return true;
+        }
+
+        std::vector<Assignment> assignments;
+        std::vector<PendingRequest> expired;
+        bool rejected = false;
+        size_t position = 0;
+        uint64_t requestId;
+
+        {
+            std::lock_guard<std::mutex> lock(m_PoolMutex);
+
+            requestId = m_NextRequestId++;
+            CatchUpLane((size_t)e.GetPriority());
+            auto& lane = m_Lanes[(size_t)e.GetPriority()];
+            lane.push_back({
+                requestId,
+                e.GetUserConnectCode(),
+                e.GetTimeout(),
+                e.GetDiscordId(),
+                e.GetPriority(),
+                m_Network.Now(),
+                probe
+            });
+            m_Journal.Accepted(requestId, e.GetDiscordId(), e.GetUserConnectCode(), e.GetTimeout(), e.GetPriority());
+
+            Schedule(assignments, expired);
+
+            // The request could not be handed to a client right away
+            if (!lane.empty() && lane.back().requestId == requestId)
+            {
+                if (lane.size() > m_MaxQueueDepth)
+                {
+                    m_CircuitBreaker.ReleaseProbe(lane.back().probe);
+                    lane.pop_back();
+                    m_Journal.Completed(requestId);
+                    PublishQueueStatus();
+                    rejected = true;
+                }
+                else
+                {
+                    position = lane.size();
+                }
+            }
+        }
+
+        Dispatch(assignments, expired);
+
+        if (rejected)
+        {
+            m_Outcomes.Append(Outcome::NoReadyClient, OutcomeLog::NoClient, 0, e.GetDiscordId(), e.GetUserConnectCode(), 0);
+
+            NoReadyClientEvent event(e.GetDiscordId(), e.GetUserConnectCode());
+            m_EventCallback(event);
+        }
+        else if (position > 0)
+        {
+            // The request may now be the first to run out of time
+            m_HealthCondition.notify_all();
+
+            QueuedEvent event(e.GetDiscordId(), requestId, e.GetUserConnectCode(), position);
+            m_EventCallback(event);
+        }
+
         return true;
     }
 
-    int64_t ClientPool::FindReadyClientIndex()
+    bool ClientPool::OnCancel(CancelEvent& e)
     {
-        for (auto& client : m_Clients)
+        std::vector<PendingRequest> cancelled;
+        bool found = false;
+
+        {
+            std::lock_guard<std::mutex> lock(m_PoolMutex);
+
+            // Requests still waiting in a lane never reached a client
+            for (auto& lane : m_Lanes)
+            {
+                for (auto iter = lane.begin(); iter != lane.end();)
+                {
+                    if (e.Matches(iter->discordId, iter->requestId))
+                    {
+                        m_Journal.Completed(iter->requestId);
+                        m_CircuitBreaker.ReleaseProbe(iter->probe);
+                        cancelled.push_back(std::move(*iter));
+                        iter = lane.erase(iter);
+                    }
+                    else
+                    {
+                        iter++;
+                    }
+                }
+            }
+
+            PublishQueueStatus();
+
+            // Running clients stop at their next wait point and report by themselves
+            for (auto& [clientId, requestId] : m_RunningRequests)
+            {
+                auto& client = m_Clients[clientId];
+                if (!client.IsQuarantined() && e.Matches(client.GetDiscordId(), requestId))
+                {
+                    client.Cancel();
+                    found = true;
+                }
+            }
+        }
+
+        auto now = m_Network.Now();
+        for (auto& request : cancelled)
         {
-            if (client.IsReady())
-                return client.GetId();
+            m_Outcomes.Append(Outcome::Cancelled, OutcomeLog::NoClient, 0, request.discordId, request.connectCode,
+                              QueuedMs(request, now));
+
+            CancelledEvent event(request.discordId, request.connectCode);
+            m_EventCallback(event);
         }
-        return -1;
+
+        return found || !cancelled.empty();
     }
 
-    void ClientPool::StartClient(const std::string& connectCode, uint32_t timeout, uint64_t discordId)
+    void ClientPool::RecoverJournal()
     {
-        uint64_t clientIndex = FindReadyClientIndex();
-        if (clientIndex != -1)
+        std::vector<JournalEntry> entries = m_Journal.TakeRecovered();
+        if (entries.empty())
+            return;
+
+        std::vector<Assignment> assignments;
+        std::vector<PendingRequest> expired;
+        std::vector<JournalEntry> aborted;
+        std::vector<std::pair<PendingRequest, size_t>> queued;
+        size_t interrupted = 0;
+
+        auto now = std::chrono::system_clock::now().time_since_epoch();
+        int64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
+
         {
-            auto& client = m_Clients[clientIndex];
+            std::lock_guard<std::mutex> lock(m_PoolMutex);
+
+            uint64_t firstRequestId = m_NextRequestId;
+            for (auto& entry : entries)
+            {
+                // The time spent down counts against the request timeout, like the time spent in the queue
+                int64_t remaining = (int64_t)entry.timeout - (nowMs - entry.acceptedAt);
+                if (remaining < m_RecoveryMinRemaining.count() || nowMs < entry.acceptedAt)
+                {
+                    aborted.push_back(std::move(entry));
+                    continue;
+                }
+
+                // Its search died with the previous process, the user gets a new bot code once it runs again
+                if (entry.startedBy)
+                {
+                    CORE_WARN("The request of {} was being searched by client {} of the previous process",
+                              entry.discordId, *entry.startedBy);
+                    interrupted++;
+                }
+
+                uint64_t requestId = m_NextRequestId++;
+                CatchUpLane((size_t)entry.priority);
+                m_Lanes[(size_t)entry.priority].push_back({
+                    requestId,
+                    entry.connectCode,
+                    (uint32_t)remaining,
+                    entry.discordId,
+                    entry.priority,
+                    m_Network.Now()
+                });
+                m_Journal.Accepted(requestId, entry.discordId, entry.connectCode, (uint32_t)remaining, entry.priority);
+            }
 
-            // Set the connect code and the timeout
-            client.PreStart(connectCode, timeout, discordId);
+            Schedule(assignments, expired);
 
-            // Automatically remove the thread when its job is done
-            std::lock_guard<std::mutex> lock(m_ThreadMutex);
-            m_Threads.emplace_back([&client, this]() {
-                    client.Start();
-                    std::thread([this] {
-                        RemoveThread(std::this_thread::get_id());
-                    }).detach();
+            // Tell the users whose request is still waiting where it stands
+            for (auto& lane : m_Lanes)
+            {
+                for (size_t i = 0; i < lane.size(); i++)
+                {
+                    if (lane[i].requestId >= firstRequestId)
+                        queued.emplace_back(lane[i], i + 1);
                 }
-            );
+            }
+        }
+
+        CORE_INFO("Recovered {} requests from the journal, {} of them interrupted in a search, {} aborted",
+                  entries.size() - aborted.size(), interrupted, aborted.size());
+
+        Dispatch(assignments, expired);
+        if (!queued.empty())
+            m_HealthCondition.notify_all();
+
+        for (auto& entry : aborted)
+        {
+            m_Outcomes.Append(Outcome::Aborted, OutcomeLog::NoClient, 0, entry.discordId, entry.connectCode, 0);
+
+            AbortedEvent event(entry.discordId, entry.connectCode);
+            m_EventCallback(event);
+        }
+
+        for (auto& [request, position] : queued)
+        {
+            QueuedEvent event(request.discordId, request.requestId, request.connectCode, position);
+            m_EventCallback(event);
+        }
+    }
+
+    void ClientPool::Reload(const Json& accounts)
+    {
+        std::vector<Assignment> assignments;
+        std::vector<PendingRequest> expired;
+        size_t added = 0, updated = 0, retired = 0;
+
+        // Keep the file order for the new accounts
+        std::vector<ClientCredentials> parsed;
+        std::unordered_map<std::string, size_t> byUid;
+        for (const auto& account : accounts)
+        {
+            auto credentials = ClientCredentials::Parse(account);
+            if (!credentials)
+                continue;
+
+            if (!byUid.emplace(credentials->uid, parsed.size()).second)
+            {
+                CORE_WARN("Account {} is listed twice, keeping the first one", credentials->uid);
+                continue;
+            }
+
+            parsed.push_back(std::move(*credentials));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_PoolMutex);
+
+            for (auto& client : m_Clients)
+            {
+                auto pending = m_PendingCredentials.find(client.GetId());
+
+                auto iter = byUid.find(client.GetCredentials().uid);
+                if (iter == byUid.end())
+                {
+                    // Busy clients may already be retired, waiting to be revived with new credentials
+                    if (!client.IsRetired() || (pending != m_PendingCredentials.end() && pending->second))
+                    {
+                        UpdateClient(client, std::nullopt);
+                        retired++;
+                    }
+                    continue;
+                }
+
+                const ClientCredentials& credentials = parsed[iter->second];
+                if (client.IsRetired() || client.GetCredentials() != credentials)
+                {
+                    // A pending update takes the place of the current credentials
+                    if (pending == m_PendingCredentials.end() || pending->second != credentials)
+                    {
+                        client.IsRetired() ? added++ : updated++;
+                        UpdateClient(client, credentials);
+                    }
+                }
+
+                byUid.erase(iter);
+            }
+
+            for (auto& credentials : parsed)
+            {
+                if (!byUid.contains(credentials.uid))
+                    continue;
+
+                AddClient(std::move(credentials));
+                added++;
+            }
+
+            Schedule(assignments, expired);
+        }
+
+        Dispatch(assignments, expired);
+
+        CORE_INFO("Accounts reloaded: {} added, {} updated, {} retired", added, updated, retired);
+    }
+
+    Client& ClientPool::AddClient(ClientCredentials credentials)
+    {
+        auto id = (uint16_t)m_Clients.size();
+
+        m_States.Resize(id + 1);
+
+        return m_Clients.emplace_back(id, std::move(credentials), m_ClientContext);
+    }
+
+    void ClientPool::UpdateClient(Client& client, std::optional<ClientCredentials> credentials)
+    {
+        // Running threads read the credentials, they are swapped once they are done
+        if (m_BusyClients.contains(client.GetId()))
+        {
+            client.Retire();
+            m_PendingCredentials[client.GetId()] = std::move(credentials);
+        }
+        else if (!credentials)
+        {
+            client.Retire();
         }
         else
         {
-            NoReadyClientEvent event(discordId, connectCode);
+            client.Revive(std::move(*credentials));
+        }
+    }
+
+    bool ClientPool::SettleClient(Client& client)
+    {
+        m_BusyClients.erase(client.GetId());
+
+        auto pending = m_PendingCredentials.find(client.GetId());
+        if (pending != m_PendingCredentials.end())
+        {
+            if (pending->second)
+                client.Revive(std::move(*pending->second));
+
+            m_PendingCredentials.erase(pending);
+            return true;
+        }
+
+        return client.IsRetired();
+    }
+
+    bool ClientPool::OnStatus(StatusEvent& e)
+    {
+        e.SetSnapshot(m_Status.Read());
+        return true;
+    }
+
+    int64_t ClientPool::FindReadyClientIndex()
+    {
+        // Prefer the healthiest account, only the ready ones are looked at
+        int64_t bestIndex = -1;
+        float bestScore = -1.0f;
+        m_States.ForEachReady([&](uint16_t id)
+        {
+            float score = m_Clients[id].GetHealth().GetScore();
+            if (score > bestScore)
+            {
+                bestScore = score;
+                bestIndex = id;
+            }
+        });
+        return bestIndex;
+    }
+
+    size_t ClientPool::CountReadyClients()
+    {
+        size_t count = 0;
+        m_States.ForEachReady([&](uint16_t) { count++; });
+        return count;
+    }
+
+    int64_t ClientPool::PickLane(size_t readyCount)
+    {
+        // Normal requests cannot take the clients reserved for the high priority lane
+        auto isEligible = [&](size_t lane)
+        {
+            if (m_Lanes[lane].empty())
+                return false;
+
+            return lane == (size_t)QueuePriority::High || readyCount > m_ReservedHighClients;
+        };
+
+        int64_t pickedLane = -1;
+        for (int64_t lane = QueuePriorityCount - 1; lane >= 0; lane--)
+        {
+            if (!isEligible(lane))
+                continue;
+
+            if (m_Policy == SchedulerPolicy::Strict)
+                return lane;
+
+            // Weighted fair: pick the lane that got the least service relative to its weight
+            if (pickedLane == -1 ||
+                m_LaneServed[lane] * m_LaneWeights[pickedLane] < m_LaneServed[pickedLane] * m_LaneWeights[lane])
+            {
+                pickedLane = lane;
+            }
+        }
+
+        if (pickedLane != -1)
+            m_LaneServed[pickedLane]++;
+
+        return pickedLane;
+    }
+
+    void ClientPool::CatchUpLane(size_t lane)
+    {
+        if (!m_Lanes[lane].empty())
+            return;
+
+        // An empty lane earns no credit, else it would get every client in a row once it fills up again.
+        // It joins at the service level of the least served lane still waiting, relative to the weights.
+        int64_t slowest = -1;
+        for (size_t other = 0; other < QueuePriorityCount; other++)
+        {
+            if (other == lane || m_Lanes[other].empty())
+                continue;
+
+            if (slowest == -1 ||
+                m_LaneServed[other] * m_LaneWeights[slowest] < m_LaneServed[slowest] * m_LaneWeights[other])
+            {
+                slowest = (int64_t)other;
+            }
+        }
+
+        if (slowest != -1)
+        {
+            uint64_t served = m_LaneServed[slowest] * m_LaneWeights[lane] / m_LaneWeights[slowest];
+            m_LaneServed[lane] = std::max(m_LaneServed[lane], served);
+        }
+    }
+
+    void ClientPool::Schedule(std::vector<Assignment>& assignments, std::vector<PendingRequest>& expired)
+    {
+        // No client is started once the pool is being destroyed
+        if (m_Stopping)
+            return;
+
+        auto now = m_Network.Now();
+
+        // Drop the requests that waited longer than their own timeout
+        for (auto& lane : m_Lanes)
+        {
+            for (auto iter = lane.begin(); iter != lane.end();)
+            {
+                if (now - iter->enqueuedAt >= std::chrono::milliseconds(iter->timeout))
+                {
+                    m_Journal.Completed(iter->requestId);
+                    m_CircuitBreaker.ReleaseProbe(iter->probe);
+                    expired.push_back(std::move(*iter));
+                    iter = lane.erase(iter);
+                }
+                else
+                {
+                    iter++;
+                }
+            }
+        }
+
+        // Start a new fairness round once every lane is drained
+        if (std::all_of(m_Lanes.begin(), m_Lanes.end(), [](const auto& lane) { return lane.empty(); }))
+        {
+            m_LaneServed.fill(0);
+            PublishQueueStatus();
+            return;
+        }
+
+        size_t readyCount = CountReadyClients();
+        while (readyCount > 0)
+        {
+            int64_t lane = PickLane(readyCount);
+            if (lane == -1)
+                break;
+
+            PendingRequest request = std::move(m_Lanes[lane].front());
+            m_Lanes[lane].pop_front();
+
+            // The time spent in the queue counts against the request timeout
+            uint32_t waited = QueuedMs(request, now);
+            request.timeout -= waited;
+
+            auto& client = m_Clients[FindReadyClientIndex()];
+            client.PreStart(request.connectCode, request.timeout, request.discordId, request.requestId, waited);
+            m_BusyClients.insert(client.GetId());
+            m_RunningRequests[client.GetId()] = request.requestId;
+            m_Status.AddRunning(1);
+            if (request.probe != 0)
+                m_RunningProbes[client.GetId()] = request.probe;
+            m_Journal.Started(request.requestId, client.GetId());
+
+            assignments.push_back({&client, std::move(request)});
+            readyCount--;
+        }
+
+        PublishQueueStatus();
+    }
+
+    uint32_t ClientPool::QueuedMs(const PendingRequest& request, std::chrono::steady_clock::time_point now)
+    {
+        return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(now - request.enqueuedAt).count();
+    }
+
+    std::optional<std::chrono::steady_clock::time_point> ClientPool::NextLaneDeadline()
+    {
+        if (!m_LaneTimer)
+            return std::nullopt;
+
+        // Timeouts differ between requests, the oldest one is not always the first to expire
+        std::optional<std::chrono::steady_clock::time_point> deadline;
+        for (auto& lane : m_Lanes)
+        {
+            for (auto& request : lane)
+            {
+                auto expiresAt = request.enqueuedAt + std::chrono::milliseconds(request.timeout);
+                if (!deadline || expiresAt < *deadline)
+                    deadline = expiresAt;
+            }
+        }
+
+        return deadline;
+    }
+
+    std::optional<std::chrono::steady_clock::time_point> ClientPool::NextProbeDue()
+    {
+        std::optional<std::chrono::steady_clock::time_point> due;
+        for (auto& client : m_Clients)
+        {
+            if (client.IsQuarantined() && (!due || client.GetQuarantinedAt() + m_ProbeInterval < *due))
+                due = client.GetQuarantinedAt() + m_ProbeInterval;
+        }
+
+        return due;
+    }
+
+    void ClientPool::PublishQueueStatus()
+    {
+        // Lanes are in arrival order, the oldest request is at the front of one of them
+        uint32_t depth = 0;
+        auto oldest = std::chrono::steady_clock::time_point::max();
+        for (auto& lane : m_Lanes)
+        {
+            depth += lane.size();
+            if (!lane.empty())
+                oldest = std::min(oldest, lane.front().enqueuedAt);
+        }
+
+        m_Status.SetQueue(depth, oldest);
+    }
+
+    void ClientPool::Dispatch(std::vector<Assignment>& assignments, std::vector<PendingRequest>& expired)
+    {
+        auto now = m_Network.Now();
+        for (auto& request : expired)
+        {
+            m_Outcomes.Append(Outcome::Timeout, OutcomeLog::NoClient, 0, request.discordId, request.connectCode,
+                              QueuedMs(request, now));
+
+            TimeoutEvent event(request.discordId, request.connectCode);
             m_EventCallback(event);
         }
+
+        for (auto& assignment : assignments)
+        {
+            [[maybe_unused]] auto queued = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    now - assignment.request.enqueuedAt);
+            SLIPPIAUTH_PROBE(admit, assignment.client->GetId(), assignment.request.discordId,
+                             (int)assignment.request.priority, assignment.request.timeout, queued.count());
+
+            StartClient(*assignment.client);
+        }
     }
 
-    void ClientPool::RemoveThread(std::thread::id id)
+    void ClientPool::StartClient(Client& client)
     {
+        if (m_Executor)
+        {
+            m_Executor([&client, this]()
+            {
+                client.Start();
+                OnClientFinished(client);
+            });
+            return;
+        }
+
         std::lock_guard<std::mutex> lock(m_ThreadMutex);
-        auto iter = std::find_if(m_Threads.begin(), m_Threads.end(), [=](std::thread &t)
+        ReapThreads();
+        m_Threads.emplace_back([&client, this]() {
+                client.Start();
+                OnClientFinished(client);
+
+                // Nothing touches the pool past this point, it can be joined right away
+                std::lock_guard<std::mutex> lock(m_ThreadMutex);
+                m_FinishedThreads.push_back(std::this_thread::get_id());
+            }
+        );
+    }
+
+    void ClientPool::OnClientFinished(Client& client)
+    {
+        std::vector<Assignment> assignments;
+        std::vector<PendingRequest> expired;
+
         {
-            return (t.get_id() == id);
-        });
+            std::lock_guard<std::mutex> lock(m_PoolMutex);
+
+            auto running = m_RunningRequests.find(client.GetId());
+            if (running != m_RunningRequests.end())
+            {
+                m_Journal.Completed(running->second);
+                m_RunningRequests.erase(running);
+                m_Status.AddRunning(-1);
+            }
 
-        if (iter != m_Threads.end())
+            // The search failed before reaching Slippi, or reported to the circuit breaker already
+            auto probe = m_RunningProbes.find(client.GetId());
+            if (probe != m_RunningProbes.end())
+            {
+                m_CircuitBreaker.ReleaseProbe(probe->second);
+                m_RunningProbes.erase(probe);
+            }
+
+            if (SettleClient(client))
+            {
+                // Retired, or revived with a new config
+            }
+            else if (client.GetHealth().GetConsecutiveFailures() >= m_QuarantineThreshold)
+            {
+                CORE_WARN("Quarantining client {} after {} failures in a row", client.GetId(),
+                          client.GetHealth().GetConsecutiveFailures());
+                client.Quarantine();
+                // Only to account for it in the next wake-up, it is validated after a whole probe interval
+                m_HealthCondition.notify_all();
+            }
+            else
+            {
+                client.MarkReady();
+            }
+
+            Schedule(assignments, expired);
+        }
+
+        Dispatch(assignments, expired);
+    }
+
+    void ClientPool::ReapThreads()
+    {
+        for (std::thread::id id : m_FinishedThreads)
+        {
+            auto iter = std::find_if(m_Threads.begin(), m_Threads.end(), [=](std::thread &t)
+            {
+                return (t.get_id() == id);
+            });
+
+            if (iter != m_Threads.end())
+            {
+                iter->join();
+                m_Threads.erase(iter);
+            }
+        }
+        m_FinishedThreads.clear();
+    }
+
+    void ClientPool::RunHealthProbes()
+    {
+        std::unique_lock<std::mutex> lock(m_PoolMutex);
+        size_t nextIndex = 0;
+        auto nextProbe = m_Network.Now();
+
+        while (!m_Stopping)
         {
-            iter->join();
-            m_Threads.erase(iter);
+            // Wake up for the next probe, or once the first waiting request runs out of time
+            std::optional<std::chrono::steady_clock::time_point> wakeAt = NextProbeDue();
+            if (wakeAt)
+                wakeAt = std::max(*wakeAt, nextProbe);
+            if (auto deadline = NextLaneDeadline())
+                wakeAt = wakeAt ? std::min(*wakeAt, *deadline) : *deadline;
+
+            if (wakeAt)
+                m_HealthCondition.wait_until(lock, std::chrono::steady_clock::now() + (*wakeAt - m_Network.Now()));
+            else
+                m_HealthCondition.wait(lock);
+            if (m_Stopping)
+                break;
+
+            auto now = m_Network.Now();
+
+            // A quiet pool with every client busy runs Schedule for nothing else
+            auto deadline = NextLaneDeadline();
+            if (deadline && *deadline <= now)
+            {
+                std::vector<Assignment> assignments;
+                std::vector<PendingRequest> expired;
+                Schedule(assignments, expired);
+
+                lock.unlock();
+                Dispatch(assignments, expired);
+                lock.lock();
+                continue;
+            }
+
+            if (now < nextProbe)
+                continue;
+
+            // Validate one client per round, in turn, once it spent a whole interval in quarantine
+            Client* quarantined = nullptr;
+            for (size_t i = 0; i < m_Clients.size() && quarantined == nullptr; i++)
+            {
+                auto& client = m_Clients[(nextIndex + i) % m_Clients.size()];
+                if (client.IsQuarantined() && now - client.GetQuarantinedAt() >= m_ProbeInterval)
+                {
+                    quarantined = &client;
+                    nextIndex = client.GetId() + 1;
+                }
+            }
+
+            if (quarantined == nullptr)
+                continue;
+            nextProbe = now + m_ProbeInterval;
+
+            // Quarantined clients are never ready so nobody else touches it meanwhile
+            m_BusyClients.insert(quarantined->GetId());
+            lock.unlock();
+            bool valid = quarantined->Validate();
+            lock.lock();
+
+            // A reload replaced or removed the account meanwhile
+            if (SettleClient(*quarantined))
+                continue;
+
+            if (!valid)
+            {
+                CORE_WARN("Client {} is still failing, keeping it in quarantine", quarantined->GetId());
+                quarantined->Quarantine();
+                continue;
+            }
+
+            CORE_INFO("Client {} validated, putting it back in rotation", quarantined->GetId());
+            quarantined->Release();
+
+            std::vector<Assignment> assignments;
+            std::vector<PendingRequest> expired;
+            Schedule(assignments, expired);
+
+            lock.unlock();
+            Dispatch(assignments, expired);
+            lock.lock();
         }
     }
 
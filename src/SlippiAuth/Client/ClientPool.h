@@ -1,25 +1,66 @@
 #pragma once
 
 #include "SlippiAuth/Client/Client.h"
+#include "SlippiAuth/Client/ClientConfigWatcher.h"
+#include "SlippiAuth/Client/ENetNetwork.h"
+#include "SlippiAuth/Client/OutcomeLog.h"
+#include "SlippiAuth/Client/RequestJournal.h"
 #include "SlippiAuth/Events/ServerEvent.h"
 #include "SlippiAuth/Core.h"
 
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <unordered_set>
+
 namespace SlippiAuth {
 
+    enum class SchedulerPolicy
+    {
+        // Always serve the highest priority lane first
+        Strict,
+        // Serve lanes proportionally to their weight
+        WeightedFair,
+    };
+
+    struct PendingRequest
+    {
+        uint64_t requestId;
+        std::string connectCode;
+        uint32_t timeout;
+        uint64_t discordId;
+        QueuePriority priority;
+        std::chrono::steady_clock::time_point enqueuedAt;
+        // Set if the request probes a half open circuit breaker
+        uint64_t probe = 0;
+    };
+
     class ClientPool
     {
     public:
-        explicit ClientPool();
+        // Runs the search of a client, by default on a thread of the pool
+        using Executor = std::function<void(std::function<void()>)>;
+
+        explicit ClientPool(Network& network = ENetNetwork::Get(), Executor executor = {});
         ~ClientPool();
 
         void OnEvent(Event& e);
         bool OnQueue(QueueEvent& e);
+        bool OnCancel(CancelEvent& e);
+        // Answered from the status counters, never takes the pool mutex
+        bool OnStatus(StatusEvent& e);
 
-        int64_t FindReadyClientIndex();
+        // Re-admit the requests a crash left in the journal, or tell their users they were aborted.
+        // Must be called once the event callbacks are set.
+        void RecoverJournal();
+
+        // Diff the accounts by uid, new ones join the pool and removed ones retire once idle
+        void Reload(const Json& accounts);
 
-        void StartClient(const std::string& connectCode, uint32_t timeout, uint64_t discordId);
+        int64_t FindReadyClientIndex();
 
-        std::vector<Client>& GetClients()
+        std::deque<Client>& GetClients()
         {
             return m_Clients;
         }
@@ -28,15 +69,105 @@ namespace SlippiAuth {
         {
             m_EventCallback = callback;
         }
+
+        // Given to every client, including the ones added by a reload
+        inline void SetClientEventCallback(const EventCallbackFn& callback)
+        {
+            m_ClientContext.eventCallback = callback;
+        }
     private:
-        void RemoveThread(std::thread::id id);
+        struct Assignment
+        {
+            Client* client;
+            PendingRequest request;
+        };
+
+        // Hand pending requests to ready clients, must be called with m_PoolMutex held
+        void Schedule(std::vector<Assignment>& assignments, std::vector<PendingRequest>& expired);
+        int64_t PickLane(size_t readyCount);
+        // Must be called with m_PoolMutex held before a request is pushed to the lane
+        void CatchUpLane(size_t lane);
+        static uint32_t QueuedMs(const PendingRequest& request, std::chrono::steady_clock::time_point now);
+        // Earliest timeout of the waiting requests, must be called with m_PoolMutex held
+        std::optional<std::chrono::steady_clock::time_point> NextLaneDeadline();
+        // Earliest time a quarantined client may be validated, must be called with m_PoolMutex held
+        std::optional<std::chrono::steady_clock::time_point> NextProbeDue();
+        // Must be called with m_PoolMutex held after the lanes changed
+        void PublishQueueStatus();
+        size_t CountReadyClients();
+
+        void Dispatch(std::vector<Assignment>& assignments, std::vector<PendingRequest>& expired);
+        void StartClient(Client& client);
+        void OnClientFinished(Client& client);
+        // Apply the credentials received while the client was busy, must be called with m_PoolMutex held.
+        // Returns false if the client has to be put back in rotation as usual.
+        bool SettleClient(Client& client);
+        // No credentials retire the client, must be called with m_PoolMutex held
+        void UpdateClient(Client& client, std::optional<ClientCredentials> credentials);
+        // Must be called with m_PoolMutex held
+        Client& AddClient(ClientCredentials credentials);
+
+        // Join the threads whose search is over, must be called with m_ThreadMutex held
+        void ReapThreads();
+
+        // Background validation of the quarantined accounts, also times out the waiting requests
+        void RunHealthProbes();
     private:
-        uint32_t m_PoolSize = ClientConfig::Get().size();
-        std::vector<Client> m_Clients;
+        Network& m_Network;
+        Executor m_Executor;
+        CircuitBreaker m_CircuitBreaker;
+        ClientStateTable m_States;
+        PoolStatus m_Status{m_Network};
+        // Declared before the clients, they log their outcomes until they are destroyed
+        OutcomeLog m_Outcomes;
+        ClientContext m_ClientContext{SlippiEndpoints::Get(), m_Network, m_CircuitBreaker, m_States, m_Status, m_Outcomes, {}};
+        // A deque never moves its elements, running threads keep references to them.
+        // Clients are only appended so their id stays their index, retired ones are reused by uid.
+        std::deque<Client> m_Clients;
         std::vector<std::thread> m_Threads;
+        // Threads done with their client, joined by the next StartClient or the destructor
+        std::vector<std::thread::id> m_FinishedThreads;
         std::mutex m_ThreadMutex;
 
+        // Guards the lanes and the ready state of the clients
+        std::mutex m_PoolMutex;
+        std::array<std::deque<PendingRequest>, QueuePriorityCount> m_Lanes;
+        std::array<uint64_t, QueuePriorityCount> m_LaneServed{};
+        uint64_t m_NextRequestId = 0;
+
+        // Every request of the lanes and the clients is journaled, with m_PoolMutex held
+        RequestJournal m_Journal;
+        // Request run by each busy client
+        std::unordered_map<uint16_t, uint64_t> m_RunningRequests;
+        // Circuit breaker probe run by a busy client, released when it never reached Slippi
+        std::unordered_map<uint16_t, uint64_t> m_RunningProbes;
+        // Recovered requests with less time left are aborted
+        std::chrono::milliseconds m_RecoveryMinRemaining;
+
+        // Clients running a search or a validation
+        std::unordered_set<uint16_t> m_BusyClients;
+        // Credentials received by a reload while their client was busy, none to retire it
+        std::unordered_map<uint16_t, std::optional<ClientCredentials>> m_PendingCredentials;
+
+        SchedulerPolicy m_Policy;
+        std::array<uint32_t, QueuePriorityCount> m_LaneWeights{};
+        // Clients only the high priority lane can take
+        uint32_t m_ReservedHighClients;
+        size_t m_MaxQueueDepth;
+        // Time out waiting requests from the health thread, not only when the pool schedules
+        bool m_LaneTimer;
+
+        // Account failures in a row before a client is quarantined
+        uint32_t m_QuarantineThreshold;
+        std::chrono::milliseconds m_ProbeInterval;
+        std::thread m_HealthThread;
+        std::condition_variable m_HealthCondition;
+        bool m_Stopping = false;
+
         EventCallbackFn m_EventCallback;
+
+        // Declared last so it stops before the pool is torn down
+        std::unique_ptr<ClientConfigWatcher> m_ConfigWatcher;
     };
 
 }
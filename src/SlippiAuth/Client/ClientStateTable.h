@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+namespace SlippiAuth {
+
+    enum class ProcessState
+    {
+        Idle,
+        Initializing,
+        Matchmaking,
+        ConnectionSuccess,
+        ErrorEncountered,
+        Timeout,
+        Cancelled,
+    };
+
+    // Hot state of every client stored field by field, so scans over the pool read contiguous memory.
+    // The ready flags are guarded by the pool mutex, states and deadlines are written by the client threads.
+    class ClientStateTable
+    {
+    public:
+        static constexpr size_t BlockSize = 256;
+
+        // Blocks are never moved so clients keep references to their slot, must be called with the pool mutex held
+        void Resize(size_t count)
+        {
+            while (m_Blocks.size() * BlockSize < count)
+                m_Blocks.push_back(std::make_unique<Block>());
+            m_Size = std::max(m_Size, count);
+        }
+
+        [[nodiscard]] size_t Size() const
+        {
+            return m_Size;
+        }
+
+        bool& Ready(uint16_t id)
+        {
+            return m_Blocks[id / BlockSize]->ready[id % BlockSize];
+        }
+
+        std::atomic<ProcessState>& State(uint16_t id)
+        {
+            return m_Blocks[id / BlockSize]->states[id % BlockSize];
+        }
+
+        // enet_time_get() at which the running search times out
+        std::atomic<uint32_t>& Deadline(uint16_t id)
+        {
+            return m_Blocks[id / BlockSize]->deadlines[id % BlockSize];
+        }
+
+        template<typename Fn>
+        void ForEachReady(Fn&& fn) const
+        {
+            for (size_t block = 0; block < m_Blocks.size(); block++)
+            {
+                const auto& ready = m_Blocks[block]->ready;
+                size_t count = std::min(BlockSize, m_Size - block * BlockSize);
+                for (size_t i = 0; i < count; i++)
+                {
+                    if (ready[i])
+                        fn((uint16_t)(block * BlockSize + i));
+                }
+            }
+        }
+    private:
+        struct Block
+        {
+            std::array<bool, BlockSize> ready{};
+            std::array<std::atomic<ProcessState>, BlockSize> states{};
+            std::array<std::atomic<uint32_t>, BlockSize> deadlines{};
+        };
+
+        std::vector<std::unique_ptr<Block>> m_Blocks;
+        size_t m_Size = 0;
+    };
+
+}
@@ -0,0 +1,164 @@
+#include "ENetNetwork.h"
+
+#include "SlippiAuth/Client/HostResolver.h"
+#include "SlippiAuth/Client/HttpSessionPool.h"
+#include "SlippiAuth/Client/OpponentHandshakeService.h"
+
+namespace SlippiAuth {
+
+    class ENetSession : public NetSession
+    {
+    public:
+        explicit ENetSession(ENetHost* host)
+            : m_Host(host) {}
+
+        ~ENetSession() override
+        {
+            if (m_Host)
+                enet_host_destroy(m_Host);
+        }
+
+        bool Connect(NetPeer peer, const ENetAddress& address) override
+        {
+            Peer(peer) = enet_host_connect(m_Host, &address, 3, 0);
+            return Peer(peer) != nullptr;
+        }
+
+        [[nodiscard]] bool HasPeer(NetPeer peer) const override
+        {
+            return m_Peers[(size_t)peer] != nullptr;
+        }
+
+        void Send(NetPeer peer, const std::string& payload) override
+        {
+            ENetPacket* packet = enet_packet_create(payload.c_str(), payload.length(), ENET_PACKET_FLAG_RELIABLE);
+            enet_peer_send(Peer(peer), 0, packet);
+        }
+
+        int Service(NetEvent& event, uint32_t timeoutMs) override
+        {
+            ENetEvent netEvent;
+            return Translate(enet_host_service(m_Host, &netEvent, timeoutMs), netEvent, event);
+        }
+
+        int CheckEvents(NetEvent& event) override
+        {
+            ENetEvent netEvent;
+            return Translate(enet_host_check_events(m_Host, &netEvent), netEvent, event);
+        }
+
+        void Disconnect(NetPeer peer) override
+        {
+            if (Peer(peer))
+                enet_peer_disconnect(Peer(peer), 0);
+        }
+
+        void DisconnectNow(NetPeer peer) override
+        {
+            if (Peer(peer))
+                enet_peer_disconnect_now(Peer(peer), 0);
+            Peer(peer) = nullptr;
+        }
+
+        void Reset(NetPeer peer) override
+        {
+            if (Peer(peer))
+                enet_peer_reset(Peer(peer));
+            Peer(peer) = nullptr;
+        }
+
+        void HandOff(std::chrono::milliseconds timeout, uint16_t port) override
+        {
+            OpponentHandshakeService::Get().Add(m_Host, Peer(NetPeer::Opponent), timeout, port);
+            m_Host = nullptr;
+            m_Peers = {};
+        }
+    private:
+        ENetPeer*& Peer(NetPeer peer)
+        {
+            return m_Peers[(size_t)peer];
+        }
+
+        int Translate(int result, ENetEvent& netEvent, NetEvent& event)
+        {
+            event.type = result > 0 ? netEvent.type : ENET_EVENT_TYPE_NONE;
+            if (result <= 0)
+                return result;
+
+            event.peer = netEvent.peer == Peer(NetPeer::Opponent) ? NetPeer::Opponent : NetPeer::Server;
+            switch (netEvent.type)
+            {
+                case ENET_EVENT_TYPE_RECEIVE:
+                    event.payload.assign((const char*)netEvent.packet->data, netEvent.packet->dataLength);
+                    enet_packet_destroy(netEvent.packet);
+                    break;
+                case ENET_EVENT_TYPE_DISCONNECT:
+                    Peer(event.peer) = nullptr;
+                    break;
+                default:
+                    break;
+            }
+
+            return result;
+        }
+    private:
+        ENetHost* m_Host;
+        std::array<ENetPeer*, 2> m_Peers{};
+    };
+
+    ENetNetwork::ENetNetwork()
+    {
+        // Initialize ENet
+        if (enet_initialize() != 0)
+        {
+            CORE_ERROR("An error occurred while initializing ENet!");
+        }
+    }
+
+    ENetNetwork::~ENetNetwork() = default;
+
+    ENetNetwork& ENetNetwork::Get()
+    {
+        static ENetNetwork s_Instance;
+        return s_Instance;
+    }
+
+    uint32_t ENetNetwork::Milliseconds()
+    {
+        return enet_time_get();
+    }
+
+    std::chrono::steady_clock::time_point ENetNetwork::Now()
+    {
+        return std::chrono::steady_clock::now();
+    }
+
+    void ENetNetwork::Prefetch(const std::string& hostName)
+    {
+        HostResolver::Get().Prefetch(hostName);
+    }
+
+    bool ENetNetwork::Resolve(const std::string& hostName, ENetAddress& address)
+    {
+        return HostResolver::Get().Resolve(hostName, address);
+    }
+
+    std::unique_ptr<NetSession> ENetNetwork::Open(uint16_t port, size_t peerCount)
+    {
+        ENetAddress address;
+        address.host = ENET_HOST_ANY;
+        address.port = port;
+
+        ENetHost* host = enet_host_create(&address, peerCount, 3, 0, 0);
+        if (host == nullptr)
+            return nullptr;
+
+        return std::make_unique<ENetSession>(host);
+    }
+
+    std::future<cpr::Response> ENetNetwork::HttpGet(const std::string& url)
+    {
+        return HttpSessionPool::Get().GetAsync(url);
+    }
+
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "SlippiAuth/Client/Network.h"
+
+namespace SlippiAuth {
+
+    // The real thing: ENet hosts, the shared DNS cache and users-rest sessions
+    class ENetNetwork : public Network
+    {
+    public:
+        ENetNetwork(const ENetNetwork&) = delete;
+        ~ENetNetwork() override;
+
+        static ENetNetwork& Get();
+
+        uint32_t Milliseconds() override;
+        std::chrono::steady_clock::time_point Now() override;
+
+        void Prefetch(const std::string& hostName) override;
+        bool Resolve(const std::string& hostName, ENetAddress& address) override;
+
+        std::unique_ptr<NetSession> Open(uint16_t port, size_t peerCount) override;
+
+        std::future<cpr::Response> HttpGet(const std::string& url) override;
+    private:
+        ENetNetwork();
+    };
+
+}
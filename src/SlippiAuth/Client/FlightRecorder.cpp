@@ -0,0 +1,92 @@
+#include "FlightRecorder.h"
+
+#include <enet/enet.h>
+
+namespace SlippiAuth {
+
+    static const char* StateName(uint8_t state)
+    {
+        switch ((ProcessState)state)
+        {
+            case ProcessState::Idle: return "Idle";
+            case ProcessState::Initializing: return "Initializing";
+            case ProcessState::Matchmaking: return "Matchmaking";
+            case ProcessState::ConnectionSuccess: return "ConnectionSuccess";
+            case ProcessState::ErrorEncountered: return "ErrorEncountered";
+            case ProcessState::Timeout: return "Timeout";
+            case ProcessState::Cancelled: return "Cancelled";
+        }
+        return "Unknown";
+    }
+
+    static const char* NetworkEventName(uint8_t type)
+    {
+        switch ((ENetEventType)type)
+        {
+            case ENET_EVENT_TYPE_NONE: return "none";
+            case ENET_EVENT_TYPE_CONNECT: return "connect";
+            case ENET_EVENT_TYPE_DISCONNECT: return "disconnect";
+            case ENET_EVENT_TYPE_RECEIVE: return "receive";
+        }
+        return "unknown";
+    }
+
+    FlightRecorder::FlightRecorder(size_t capacity)
+    {
+        if (capacity == 0)
+            return;
+
+        size_t size = 1;
+        while (size < capacity)
+            size <<= 1;
+
+        m_Entries = std::make_unique<FlightEntry[]>(size);
+        m_Mask = size - 1;
+    }
+
+    void FlightRecorder::Reset()
+    {
+        m_Start = std::chrono::steady_clock::now();
+        m_Head.store(0, std::memory_order_release);
+    }
+
+    void FlightRecorder::Dump(uint16_t clientId) const
+    {
+        if (!m_Entries)
+            return;
+
+        uint64_t head = m_Head.load(std::memory_order_acquire);
+        uint64_t count = std::min<uint64_t>(head, m_Mask + 1);
+
+        CLIENT_WARN(clientId, "Flight recorder, last {} of {} events:", count, head);
+        for (uint64_t i = head - count; i < head; i++)
+        {
+            const FlightEntry& entry = m_Entries[i & m_Mask];
+            double ms = entry.time / 1000.0;
+
+            switch (entry.event)
+            {
+                case FlightEvent::State:
+                    CLIENT_WARN(clientId, "  +{:.3f}ms state {} -> {}", ms,
+                                StateName(entry.previous), StateName(entry.code));
+                    break;
+                case FlightEvent::Network:
+                    if (entry.previous)
+                        CLIENT_WARN(clientId, "  +{:.3f}ms enet failed", ms);
+                    else
+                        CLIENT_WARN(clientId, "  +{:.3f}ms enet {} {}B", ms, NetworkEventName(entry.code), entry.size);
+                    break;
+                case FlightEvent::Sent:
+                    CLIENT_WARN(clientId, "  +{:.3f}ms sent {} {}B", ms, entry.text, entry.size);
+                    break;
+                case FlightEvent::Received:
+                    CLIENT_WARN(clientId, "  +{:.3f}ms received {} {}B", ms, entry.text, entry.size);
+                    break;
+                case FlightEvent::Error:
+                    CLIENT_WARN(clientId, "  +{:.3f}ms error {}", ms, entry.text);
+                    break;
+            }
+        }
+    }
+
+}
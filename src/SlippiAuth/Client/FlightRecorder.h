@@ -0,0 +1,107 @@
+#pragma once
+
+#include "SlippiAuth/Client/ClientStateTable.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string_view>
+
+namespace SlippiAuth {
+
+    enum class FlightEvent : uint8_t
+    {
+        State,
+        // One enet_host_service call, code is its ENet event type
+        Network,
+        Sent,
+        Received,
+        // Error field of the last received message
+        Error,
+    };
+
+    struct FlightEntry
+    {
+        // Microseconds since the recorder was reset
+        uint32_t time;
+        FlightEvent event;
+        uint8_t code;
+        uint8_t previous;
+        uint8_t padding;
+        uint32_t size;
+        char text[20];
+    };
+    static_assert(sizeof(FlightEntry) == 32, "Flight entries must stay 32 bytes");
+
+    // Last events of a client, always recorded and only decoded when a search goes wrong.
+    // Written by the thread running the client, entries are overwritten once the ring is full.
+    class FlightRecorder
+    {
+    public:
+        // The capacity is rounded up to a power of two, 0 disables the recorder
+        explicit FlightRecorder(size_t capacity);
+
+        void Reset();
+
+        inline void RecordState(ProcessState previous, ProcessState state)
+        {
+            if (FlightEntry* entry = Next(FlightEvent::State))
+            {
+                entry->previous = (uint8_t)previous;
+                entry->code = (uint8_t)state;
+                Commit();
+            }
+        }
+
+        inline void RecordNetwork(int result, uint8_t type, size_t size)
+        {
+            if (FlightEntry* entry = Next(FlightEvent::Network))
+            {
+                entry->previous = (uint8_t)(result < 0);
+                entry->code = result > 0 ? type : 0;
+                entry->size = (uint32_t)size;
+                Commit();
+            }
+        }
+
+        inline void RecordMessage(FlightEvent event, std::string_view text, size_t size)
+        {
+            if (FlightEntry* entry = Next(event))
+            {
+                // Message types and errors are short, the start is enough to tell them apart
+                size_t length = std::min(text.size(), sizeof(entry->text) - 1);
+                text.copy(entry->text, length);
+                entry->text[length] = '\0';
+                entry->size = (uint32_t)size;
+                Commit();
+            }
+        }
+
+        // Log the recorded events, oldest first
+        void Dump(uint16_t clientId) const;
+    private:
+        inline FlightEntry* Next(FlightEvent event)
+        {
+            if (!m_Entries)
+                return nullptr;
+
+            FlightEntry* entry = &m_Entries[m_Head.load(std::memory_order_relaxed) & m_Mask];
+            *entry = {};
+            entry->event = event;
+            entry->time = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - m_Start).count();
+            return entry;
+        }
+
+        inline void Commit()
+        {
+            m_Head.store(m_Head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+    private:
+        std::unique_ptr<FlightEntry[]> m_Entries;
+        size_t m_Mask = 0;
+        std::atomic<uint64_t> m_Head = 0;
+        std::chrono::steady_clock::time_point m_Start = std::chrono::steady_clock::now();
+    };
+
+}
@@ -0,0 +1,143 @@
+#include "HostResolver.h"
+
+#include "SlippiAuth/AppConfig.h"
+
+namespace SlippiAuth {
+
+    HostResolver::HostResolver()
+        : m_Ttl(AppConfig::Value("dns", "ttl", 300000u))
+    {
+        m_Thread = std::thread([this]() { Run(); });
+    }
+
+    HostResolver::~HostResolver()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Stopping = true;
+        }
+        m_PendingCondition.notify_all();
+        m_Thread.join();
+    }
+
+    HostResolver& HostResolver::Get()
+    {
+        static HostResolver s_Instance;
+        return s_Instance;
+    }
+
+    bool HostResolver::Resolve(const std::string& hostName, ENetAddress& address)
+    {
+        // Ip literals never need the resolver
+        if (enet_address_set_host_ip(&address, hostName.c_str()) == 0)
+            return true;
+
+        std::unique_lock<std::mutex> lock(m_Mutex);
+
+        auto iter = m_Cache.find(hostName);
+        if (iter == m_Cache.end() || !iter->second.resolved)
+        {
+            QueueRefresh(hostName);
+
+            bool resolved = m_ResolvedCondition.wait_for(lock, m_MissTimeout, [&]()
+            {
+                auto entry = m_Cache.find(hostName);
+                return entry != m_Cache.end() && (entry->second.resolved || !entry->second.refreshing);
+            });
+
+            iter = m_Cache.find(hostName);
+            if (!resolved || !iter->second.resolved)
+                return false;
+        }
+
+        // Serve the stale address, the refresh lands for the next caller
+        if (iter->second.expiresAt <= Clock::now())
+            QueueRefresh(hostName);
+
+        address.host = iter->second.host;
+        return true;
+    }
+
+    void HostResolver::Prefetch(const std::string& hostName)
+    {
+        ENetAddress address;
+        if (enet_address_set_host_ip(&address, hostName.c_str()) == 0)
+            return;
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        QueueRefresh(hostName);
+    }
+
+    void HostResolver::QueueRefresh(const std::string& hostName)
+    {
+        auto& entry = m_Cache[hostName];
+        if (entry.refreshing)
+            return;
+
+        entry.refreshing = true;
+        m_Pending.push_back(hostName);
+        m_PendingCondition.notify_one();
+    }
+
+    void HostResolver::Run()
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+
+        while (!m_Stopping)
+        {
+            // Wake up before the next entry expires to refresh it ahead of time
+            auto nextWake = Clock::now() + m_Ttl;
+            for (auto& [hostName, entry] : m_Cache)
+            {
+                if (entry.resolved && !entry.refreshing)
+                    nextWake = std::min(nextWake, entry.refreshAt);
+            }
+
+            m_PendingCondition.wait_until(lock, nextWake, [this]() { return m_Stopping || !m_Pending.empty(); });
+            if (m_Stopping)
+                break;
+
+            auto now = Clock::now();
+            for (auto& [hostName, entry] : m_Cache)
+            {
+                if (entry.resolved && !entry.refreshing && entry.refreshAt <= now)
+                {
+                    entry.refreshing = true;
+                    m_Pending.push_back(hostName);
+                }
+            }
+
+            while (!m_Pending.empty() && !m_Stopping)
+            {
+                std::string hostName = std::move(m_Pending.front());
+                m_Pending.pop_front();
+
+                // getaddrinfo can take seconds, never hold the lock meanwhile
+                lock.unlock();
+                ENetAddress address;
+                bool resolved = enet_address_set_host(&address, hostName.c_str()) == 0;
+                lock.lock();
+
+                auto& entry = m_Cache[hostName];
+                entry.refreshing = false;
+
+                if (resolved)
+                {
+                    entry.host = address.host;
+                    entry.resolved = true;
+                    entry.expiresAt = Clock::now() + m_Ttl;
+                    entry.refreshAt = Clock::now() + m_Ttl * 9 / 10;
+                }
+                else
+                {
+                    // Keep serving the last known address and try again soon
+                    CORE_WARN("Failed to resolve {}", hostName);
+                    entry.refreshAt = Clock::now() + m_RetryDelay;
+                }
+            }
+
+            m_ResolvedCondition.notify_all();
+        }
+    }
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "SlippiAuth/Core.h"
+
+#include <enet/enet.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace SlippiAuth {
+
+    // Shared DNS cache, lookups happen on a background thread so clients never block on the resolver
+    class HostResolver
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        HostResolver(const HostResolver&) = delete;
+        ~HostResolver();
+
+        static HostResolver& Get();
+
+        // Fill the host of the address, numeric addresses are parsed in place.
+        // Only waits if the name was never resolved before, stale entries are served while refreshing.
+        bool Resolve(const std::string& hostName, ENetAddress& address);
+
+        // Start resolving a name ahead of its first use
+        void Prefetch(const std::string& hostName);
+    private:
+        HostResolver();
+
+        void Run();
+        // Must be called with m_Mutex held
+        void QueueRefresh(const std::string& hostName);
+    private:
+        struct Entry
+        {
+            enet_uint32 host = 0;
+            bool resolved = false;
+            bool refreshing = false;
+            Clock::time_point expiresAt{};
+            // Refreshed ahead of the expiry so lookups rarely see a stale entry
+            Clock::time_point refreshAt{};
+        };
+
+        std::mutex m_Mutex;
+        std::condition_variable m_PendingCondition;
+        std::condition_variable m_ResolvedCondition;
+        std::unordered_map<std::string, Entry> m_Cache;
+        std::deque<std::string> m_Pending;
+
+        std::chrono::milliseconds m_Ttl;
+        // Retry delay for names that failed to resolve
+        std::chrono::milliseconds m_RetryDelay{5000};
+        // How long a first lookup may wait
+        std::chrono::milliseconds m_MissTimeout{2000};
+
+        std::thread m_Thread;
+        bool m_Stopping = false;
+    };
+
+}
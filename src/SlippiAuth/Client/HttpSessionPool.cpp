@@ -0,0 +1,72 @@
+#include "HttpSessionPool.h"
+
+#include "SlippiAuth/AppConfig.h"
+
+#include <curl/curl.h>
+
+namespace SlippiAuth {
+
+    HttpSessionPool::HttpSessionPool()
+        : m_MaxSessions(std::max(AppConfig::Value("http", "maxSessions", (size_t)8), (size_t)1)),
+        m_VerifySsl(AppConfig::Value("http", "verifySsl", false)),
+        m_Timeout(AppConfig::Value("http", "timeout", 5000u)) {}
+
+    HttpSessionPool& HttpSessionPool::Get()
+    {
+        static HttpSessionPool s_Instance;
+        return s_Instance;
+    }
+
+    cpr::Response HttpSessionPool::Get(const std::string& url)
+    {
+        std::unique_ptr<cpr::Session> session = Acquire();
+
+        session->SetUrl(cpr::Url{url});
+        cpr::Response response = session->Get();
+
+        Release(std::move(session));
+        return response;
+    }
+
+    std::future<cpr::Response> HttpSessionPool::GetAsync(const std::string& url)
+    {
+        return std::async(std::launch::async, [this, url]() { return Get(url); });
+    }
+
+    std::unique_ptr<cpr::Session> HttpSessionPool::Acquire()
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Condition.wait(lock, [this]() { return !m_IdleSessions.empty() || m_SessionCount < m_MaxSessions; });
+
+        if (!m_IdleSessions.empty())
+        {
+            std::unique_ptr<cpr::Session> session = std::move(m_IdleSessions.back());
+            m_IdleSessions.pop_back();
+            return session;
+        }
+
+        m_SessionCount++;
+        lock.unlock();
+
+        auto session = std::make_unique<cpr::Session>();
+        session->SetVerifySsl(cpr::VerifySsl(m_VerifySsl));
+        session->SetTimeout(cpr::Timeout{m_Timeout});
+
+        // Keep the connection warm between requests and let curl negotiate HTTP/2 over TLS
+        CURL* handle = session->GetCurlHolder()->handle;
+        curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+
+        return session;
+    }
+
+    void HttpSessionPool::Release(std::unique_ptr<cpr::Session> session)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_IdleSessions.push_back(std::move(session));
+        }
+        m_Condition.notify_one();
+    }
+
+}
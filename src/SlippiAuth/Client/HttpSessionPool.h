@@ -0,0 +1,40 @@
+#pragma once
+
+#include "SlippiAuth/Core.h"
+
+#include <cpr/cpr.h>
+
+#include <condition_variable>
+#include <future>
+#include <mutex>
+
+namespace SlippiAuth {
+
+    // Curl handles shared by every client so TCP and TLS connections are reused between requests
+    class HttpSessionPool
+    {
+    public:
+        HttpSessionPool(const HttpSessionPool&) = delete;
+
+        static HttpSessionPool& Get();
+
+        // Waits for a free session, at most `maxSessions` requests are outstanding
+        cpr::Response Get(const std::string& url);
+        std::future<cpr::Response> GetAsync(const std::string& url);
+    private:
+        HttpSessionPool();
+
+        std::unique_ptr<cpr::Session> Acquire();
+        void Release(std::unique_ptr<cpr::Session> session);
+    private:
+        std::mutex m_Mutex;
+        std::condition_variable m_Condition;
+        std::vector<std::unique_ptr<cpr::Session>> m_IdleSessions;
+        size_t m_SessionCount = 0;
+
+        size_t m_MaxSessions;
+        bool m_VerifySsl;
+        std::chrono::milliseconds m_Timeout;
+    };
+
+}
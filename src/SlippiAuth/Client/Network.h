@@ -0,0 +1,74 @@
+#pragma once
+
+#include "SlippiAuth/Core.h"
+
+#include <cpr/cpr.h>
+#include <enet/enet.h>
+
+#include <chrono>
+#include <future>
+
+namespace SlippiAuth {
+
+    enum class NetPeer : uint8_t
+    {
+        Server,
+        Opponent,
+    };
+
+    // An ENet event with the payload already copied out of its packet
+    struct NetEvent
+    {
+        ENetEventType type = ENET_EVENT_TYPE_NONE;
+        NetPeer peer = NetPeer::Server;
+        std::string payload;
+    };
+
+    // The host of one client, connected to the matchmaking server and then to the opponent
+    class NetSession
+    {
+    public:
+        virtual ~NetSession() = default;
+
+        // Start connecting, a CONNECT event follows once the peer answered
+        virtual bool Connect(NetPeer peer, const ENetAddress& address) = 0;
+        [[nodiscard]] virtual bool HasPeer(NetPeer peer) const = 0;
+
+        virtual void Send(NetPeer peer, const std::string& payload) = 0;
+        // Same results as enet_host_service, a DISCONNECT event forgets its peer
+        virtual int Service(NetEvent& event, uint32_t timeoutMs) = 0;
+        // Next event already received by the last Service call, without touching the socket
+        virtual int CheckEvents(NetEvent& event) = 0;
+
+        // Ask the peer to disconnect, a DISCONNECT event follows once it acknowledged
+        virtual void Disconnect(NetPeer peer) = 0;
+        // Tell the peer and forget it without waiting
+        virtual void DisconnectNow(NetPeer peer) = 0;
+        // Forget the peer without telling it
+        virtual void Reset(NetPeer peer) = 0;
+
+        // Give the opponent connection to the background handshake service, nothing is left in the session.
+        // The host port goes back to the PortAllocator once the handshake is over.
+        virtual void HandOff(std::chrono::milliseconds timeout, uint16_t port) = 0;
+    };
+
+    // Clock and network of the clients, so the pool can run against a simulation
+    class Network
+    {
+    public:
+        virtual ~Network() = default;
+
+        // Wraps around like enet_time_get
+        virtual uint32_t Milliseconds() = 0;
+        virtual std::chrono::steady_clock::time_point Now() = 0;
+
+        virtual void Prefetch(const std::string& hostName) = 0;
+        virtual bool Resolve(const std::string& hostName, ENetAddress& address) = 0;
+
+        // Bind a host on the port, nullptr if it is taken
+        virtual std::unique_ptr<NetSession> Open(uint16_t port, size_t peerCount) = 0;
+
+        virtual std::future<cpr::Response> HttpGet(const std::string& url) = 0;
+    };
+
+}
@@ -0,0 +1,125 @@
+#include "OpponentHandshakeService.h"
+
+#include "SlippiAuth/AppConfig.h"
+#include "SlippiAuth/Client/PortAllocator.h"
+
+namespace SlippiAuth {
+
+    OpponentHandshakeService::OpponentHandshakeService()
+    {
+        m_Thread = std::thread([this]() { Run(); });
+    }
+
+    OpponentHandshakeService::~OpponentHandshakeService()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Stopping = true;
+        }
+        m_Condition.notify_all();
+        m_Thread.join();
+    }
+
+    OpponentHandshakeService& OpponentHandshakeService::Get()
+    {
+        static OpponentHandshakeService s_Instance;
+        return s_Instance;
+    }
+
+    OpponentHandshake OpponentHandshakeService::GetMode()
+    {
+        static const OpponentHandshake s_Mode = []()
+        {
+            std::string mode = AppConfig::Value<std::string>("client", "opponentHandshake", "blocking");
+            if (mode == "background")
+                return OpponentHandshake::Background;
+            if (mode == "skip")
+                return OpponentHandshake::Skip;
+            return OpponentHandshake::Blocking;
+        }();
+
+        return s_Mode;
+    }
+
+    void OpponentHandshakeService::Add(ENetHost* host, ENetPeer* peer, std::chrono::milliseconds timeout, uint16_t port)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Incoming.push_back({host, peer, Clock::now() + timeout, false, port});
+        }
+        m_Condition.notify_one();
+    }
+
+    void OpponentHandshakeService::Run()
+    {
+        std::vector<Handshake> handshakes;
+
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+
+                // Sleep until there is something to do, otherwise poll every few milliseconds
+                if (handshakes.empty())
+                    m_Condition.wait(lock, [this]() { return m_Stopping || !m_Incoming.empty(); });
+                else
+                    m_Condition.wait_for(lock, std::chrono::milliseconds(5));
+
+                if (m_Stopping)
+                    break;
+
+                handshakes.insert(handshakes.end(), m_Incoming.begin(), m_Incoming.end());
+                m_Incoming.clear();
+            }
+
+            auto now = Clock::now();
+            for (auto iter = handshakes.begin(); iter != handshakes.end();)
+            {
+                ENetEvent netEvent;
+                while (enet_host_service(iter->host, &netEvent, 0) > 0)
+                {
+                    if (netEvent.type == ENET_EVENT_TYPE_CONNECT && !iter->connected)
+                    {
+                        // Hang up right away, the deadline now only covers the disconnect
+                        iter->connected = true;
+                        iter->deadline = std::min(iter->deadline, now + s_DisconnectGrace);
+                        enet_peer_disconnect(iter->peer, 0);
+                    }
+                    else if (netEvent.type == ENET_EVENT_TYPE_RECEIVE)
+                    {
+                        enet_packet_destroy(netEvent.packet);
+                    }
+                    else if (netEvent.type == ENET_EVENT_TYPE_DISCONNECT)
+                    {
+                        iter->deadline = now;
+                    }
+                }
+
+                if (iter->deadline <= now)
+                {
+                    Destroy(*iter);
+                    iter = handshakes.erase(iter);
+                }
+                else
+                {
+                    iter++;
+                }
+            }
+        }
+
+        for (auto& handshake : handshakes)
+            Destroy(handshake);
+
+        for (auto& handshake : m_Incoming)
+            Destroy(handshake);
+    }
+
+    void OpponentHandshakeService::Destroy(const Handshake& handshake)
+    {
+        enet_host_destroy(handshake.host);
+
+        if (handshake.port != 0)
+            PortAllocator::Get().Release(handshake.port);
+    }
+
+}
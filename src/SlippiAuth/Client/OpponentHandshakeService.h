@@ -0,0 +1,68 @@
+#pragma once
+
+#include "SlippiAuth/Core.h"
+
+#include <enet/enet.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace SlippiAuth {
+
+    enum class OpponentHandshake
+    {
+        // The client connects to the opponent before going back in the pool
+        Blocking,
+        // The connection is handed to a shared background thread
+        Background,
+        // The user is authenticated by the match alone
+        Skip,
+    };
+
+    // Finishes the opponent handshakes of every client on one thread so the clients go back in rotation
+    class OpponentHandshakeService
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        OpponentHandshakeService(const OpponentHandshakeService&) = delete;
+        ~OpponentHandshakeService();
+
+        static OpponentHandshakeService& Get();
+
+        // Read once from the app config
+        static OpponentHandshake GetMode();
+
+        // Takes ownership of the host, it is destroyed once the peer connected or the timeout elapsed.
+        // Its port is then released to the PortAllocator, unless it is 0.
+        void Add(ENetHost* host, ENetPeer* peer, std::chrono::milliseconds timeout, uint16_t port);
+    private:
+        OpponentHandshakeService();
+
+        void Run();
+    private:
+        struct Handshake
+        {
+            ENetHost* host;
+            ENetPeer* peer;
+            Clock::time_point deadline;
+            bool connected;
+            uint16_t port;
+        };
+
+        // Destroy the host and give its port back
+        static void Destroy(const Handshake& handshake);
+
+        std::mutex m_Mutex;
+        std::condition_variable m_Condition;
+        std::vector<Handshake> m_Incoming;
+
+        std::thread m_Thread;
+        bool m_Stopping = false;
+
+        // Time left to the opponent to receive our disconnect once connected
+        static constexpr auto s_DisconnectGrace = std::chrono::milliseconds(500);
+    };
+
+}
@@ -0,0 +1,193 @@
+#include "OutcomeLog.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace SlippiAuth {
+
+    const char* OutcomeName(Outcome outcome)
+    {
+        switch (outcome)
+        {
+            case Outcome::Authenticated: return "authenticated";
+            case Outcome::Timeout: return "timeout";
+            case Outcome::SlippiError: return "slippiErr";
+            case Outcome::NoReadyClient: return "noReadyClient";
+            case Outcome::UpstreamDown: return "upstreamDown";
+            case Outcome::Cancelled: return "cancelled";
+            case Outcome::Aborted: return "aborted";
+        }
+        return "unknown";
+    }
+
+    OutcomeLog::OutcomeLog(std::string path, size_t batchSize, std::chrono::milliseconds flushInterval)
+        : m_Path(std::move(path)), m_BatchSize(std::max(batchSize, (size_t)1)), m_FlushInterval(flushInterval)
+    {
+        // No path, no log
+        if (m_Path.empty())
+            return;
+
+        m_Fd = open(m_Path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        struct stat info{};
+        if (m_Fd < 0 || fstat(m_Fd, &info) != 0)
+        {
+            CORE_ERROR("Cannot open the outcome log {}, outcomes will not be recorded", m_Path);
+            if (m_Fd >= 0)
+                close(m_Fd);
+            m_Fd = -1;
+            return;
+        }
+
+        if (info.st_size == 0)
+        {
+            OutcomeLogHeader header{Magic, Version, sizeof(OutcomeRecord), {}};
+            if (write(m_Fd, &header, sizeof(header)) != sizeof(header))
+            {
+                CORE_ERROR("Cannot write the outcome log {}, outcomes will not be recorded", m_Path);
+                close(m_Fd);
+                m_Fd = -1;
+                return;
+            }
+        }
+        else
+        {
+            OutcomeLogHeader header{};
+            if (pread(m_Fd, &header, sizeof(header), 0) != sizeof(header) || header.magic != Magic ||
+                header.version != Version || header.recordSize != sizeof(OutcomeRecord))
+            {
+                CORE_ERROR("{} is not an outcome log of this version, outcomes will not be recorded", m_Path);
+                close(m_Fd);
+                m_Fd = -1;
+                return;
+            }
+
+            // A crash in the middle of a batch leaves a partial record behind
+            off_t records = (info.st_size - (off_t)sizeof(header)) / (off_t)sizeof(OutcomeRecord);
+            off_t size = (off_t)sizeof(header) + records * (off_t)sizeof(OutcomeRecord);
+            if (size != info.st_size && ftruncate(m_Fd, size) != 0)
+                CORE_WARN("Cannot drop the partial record at the end of {}", m_Path);
+        }
+
+        m_Buffer.reserve(m_BatchSize);
+        m_WriterThread = std::thread([this]() { RunWriter(); });
+    }
+
+    OutcomeLog::~OutcomeLog()
+    {
+        if (m_WriterThread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                m_Stopping = true;
+            }
+            m_Condition.notify_all();
+            m_WriterThread.join();
+        }
+
+        if (m_Fd >= 0)
+            close(m_Fd);
+    }
+
+    uint32_t OutcomeLog::AccountKey(const std::string& uid)
+    {
+        uint32_t hash = 2166136261u;
+        for (char c : uid)
+        {
+            hash ^= (uint8_t)c;
+            hash *= 16777619u;
+        }
+        return hash != 0 ? hash : 1;
+    }
+
+    void OutcomeLog::Append(Outcome outcome, uint16_t clientId, uint32_t accountKey, uint64_t discordId,
+                            const std::string& connectCode, uint32_t queuedMs, uint32_t searchMs,
+                            const SearchTimings& phaseMs)
+    {
+        if (m_Fd < 0)
+            return;
+
+        OutcomeRecord record{};
+        record.time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        record.discordId = discordId;
+        record.queuedMs = queuedMs;
+        record.searchMs = searchMs;
+        record.phaseMs = phaseMs;
+        record.clientId = clientId;
+        record.accountKey = accountKey;
+        record.outcome = outcome;
+        connectCode.copy(record.connectCode, std::min(connectCode.size(), sizeof(record.connectCode)));
+
+        bool full;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (m_Buffer.size() >= m_BatchSize * s_MaxBatches)
+            {
+                m_Dropped++;
+                return;
+            }
+
+            m_Buffer.push_back(record);
+            full = m_Buffer.size() >= m_BatchSize;
+        }
+
+        if (full)
+            m_Condition.notify_one();
+    }
+
+    void OutcomeLog::RunWriter()
+    {
+        std::vector<OutcomeRecord> batch;
+        batch.reserve(m_BatchSize);
+
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        while (true)
+        {
+            m_Condition.wait_for(lock, m_FlushInterval, [this]()
+            {
+                return m_Stopping || m_Buffer.size() >= m_BatchSize;
+            });
+
+            bool stopping = m_Stopping;
+            uint64_t dropped = std::exchange(m_Dropped, 0);
+            batch.swap(m_Buffer);
+
+            lock.unlock();
+            if (dropped > 0)
+                CORE_WARN("The outcome log fell behind, {} outcomes were dropped", dropped);
+            if (!batch.empty())
+                Write(batch);
+            batch.clear();
+            lock.lock();
+
+            // Anything appended while the last batch was written goes out before leaving
+            if (stopping && m_Buffer.empty())
+                return;
+        }
+    }
+
+    void OutcomeLog::Write(const std::vector<OutcomeRecord>& records)
+    {
+        auto* data = reinterpret_cast<const char*>(records.data());
+        size_t remaining = records.size() * sizeof(OutcomeRecord);
+
+        while (remaining > 0)
+        {
+            ssize_t written = write(m_Fd, data, remaining);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                CORE_ERROR("Cannot write the outcome log {}, {} outcomes lost", m_Path,
+                           remaining / sizeof(OutcomeRecord));
+                return;
+            }
+
+            data += written;
+            remaining -= (size_t)written;
+        }
+    }
+
+}
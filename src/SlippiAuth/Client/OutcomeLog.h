@@ -0,0 +1,114 @@
+#pragma once
+
+#include "SlippiAuth/Core.h"
+
+#include <array>
+#include <condition_variable>
+#include <mutex>
+
+namespace SlippiAuth {
+
+    enum class Outcome : uint8_t
+    {
+        Authenticated = 1,
+        Timeout,
+        SlippiError,
+        NoReadyClient,
+        UpstreamDown,
+        Cancelled,
+        Aborted,
+    };
+    constexpr size_t OutcomeCount = 8;
+
+    const char* OutcomeName(Outcome outcome);
+
+    // Phases of Client::Start, the ones a search never reached stay at 0
+    enum class SearchPhase : uint8_t
+    {
+        // Port, resolution and connection to the matchmaking server
+        Connect,
+        // create-ticket round trip
+        Ticket,
+        // Waiting for the match
+        Matchmaking,
+        // Leaving the server and greeting the opponent
+        Handshake,
+    };
+    constexpr size_t SearchPhaseCount = 4;
+
+    using SearchTimings = std::array<uint32_t, SearchPhaseCount>;
+
+    struct OutcomeRecord
+    {
+        // System clock, in milliseconds since epoch
+        int64_t time;
+        uint64_t discordId;
+        // Time spent in a lane, then in Client::Start
+        uint32_t queuedMs;
+        uint32_t searchMs;
+        SearchTimings phaseMs;
+        uint16_t clientId;
+        Outcome outcome;
+        uint8_t padding;
+        char connectCode[16];
+        // Hash of the uid of the bot account, stable across restarts and reloads unlike clientId
+        uint32_t accountKey;
+    };
+    static_assert(sizeof(OutcomeRecord) == 64, "Outcome records must stay 64 bytes");
+
+    struct OutcomeLogHeader
+    {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t recordSize;
+        uint8_t reserved[8];
+    };
+    static_assert(sizeof(OutcomeLogHeader) == 16, "The outcome log header must stay 16 bytes");
+
+    // Append-only binary log of every answered request, for the offline reports of SlippiAuthOutcomes.
+    // Records are buffered in memory and written in batches by a background thread.
+    class OutcomeLog
+    {
+    public:
+        static constexpr uint32_t Magic = 0x314F4153; // "SAO1"
+        static constexpr uint16_t Version = 2;
+        // Outcomes decided by the pool, before any client took the request
+        static constexpr uint16_t NoClient = 0xFFFF;
+
+        OutcomeLog(std::string path, size_t batchSize, std::chrono::milliseconds flushInterval);
+        OutcomeLog(const OutcomeLog&) = delete;
+        ~OutcomeLog();
+
+        [[nodiscard]] bool IsOpen() const
+        {
+            return m_Fd >= 0;
+        }
+
+        // FNV-1a of the account uid, 0 is left for the outcomes decided by the pool
+        static uint32_t AccountKey(const std::string& uid);
+
+        // Can be called from any thread, the record is timestamped here
+        void Append(Outcome outcome, uint16_t clientId, uint32_t accountKey, uint64_t discordId,
+                    const std::string& connectCode, uint32_t queuedMs, uint32_t searchMs = 0,
+                    const SearchTimings& phaseMs = {});
+    private:
+        void RunWriter();
+        void Write(const std::vector<OutcomeRecord>& records);
+    private:
+        std::string m_Path;
+        size_t m_BatchSize;
+        std::chrono::milliseconds m_FlushInterval;
+        int m_Fd = -1;
+
+        std::mutex m_Mutex;
+        std::condition_variable m_Condition;
+        std::vector<OutcomeRecord> m_Buffer;
+        uint64_t m_Dropped = 0;
+        bool m_Stopping = false;
+        std::thread m_WriterThread;
+
+        // Records kept in memory while the disk is too slow, in batches
+        static constexpr size_t s_MaxBatches = 64;
+    };
+
+}
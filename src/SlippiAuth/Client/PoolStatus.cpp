@@ -0,0 +1,86 @@
+#include "PoolStatus.h"
+
+namespace SlippiAuth {
+
+    static std::atomic<int32_t>* CounterOf(ProcessState state, std::atomic<int32_t>& searching,
+                                           std::atomic<int32_t>& connecting)
+    {
+        switch (state)
+        {
+            case ProcessState::Initializing:
+            case ProcessState::Matchmaking:
+                return &searching;
+            case ProcessState::ConnectionSuccess:
+                return &connecting;
+            default:
+                return nullptr;
+        }
+    }
+
+    void PoolStatus::OnStateChange(ProcessState from, ProcessState to)
+    {
+        auto* previous = CounterOf(from, m_Searching, m_Connecting);
+        auto* next = CounterOf(to, m_Searching, m_Connecting);
+        if (previous == next)
+            return;
+
+        if (previous)
+            previous->fetch_sub(1, std::memory_order_relaxed);
+        if (next)
+            next->fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void PoolStatus::SetQueue(uint32_t depth, Clock::time_point oldestEnqueuedAt)
+    {
+        uint64_t sequence = m_QueueSequence.load(std::memory_order_relaxed);
+        m_QueueSequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        m_QueueDepth.store(depth, std::memory_order_relaxed);
+        m_OldestEnqueuedAt.store(depth > 0 ? oldestEnqueuedAt.time_since_epoch().count() : 0,
+                                 std::memory_order_relaxed);
+
+        m_QueueSequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    PoolStatusSnapshot PoolStatus::Read() const
+    {
+        PoolStatusSnapshot snapshot;
+
+        // Counters can be briefly negative while a transition is half applied
+        auto read = [](const std::atomic<int32_t>& counter)
+        {
+            return (uint32_t)std::max(counter.load(std::memory_order_relaxed), 0);
+        };
+
+        snapshot.idle = read(m_Idle);
+        snapshot.searching = read(m_Searching);
+        snapshot.connecting = read(m_Connecting);
+        snapshot.quarantined = read(m_Quarantined);
+        snapshot.running = read(m_Running);
+
+        Clock::rep oldestEnqueuedAt;
+        while (true)
+        {
+            uint64_t sequence = m_QueueSequence.load(std::memory_order_acquire);
+            if (sequence & 1)
+                continue;
+
+            snapshot.queueDepth = m_QueueDepth.load(std::memory_order_relaxed);
+            oldestEnqueuedAt = m_OldestEnqueuedAt.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_QueueSequence.load(std::memory_order_relaxed) == sequence)
+                break;
+        }
+
+        if (snapshot.queueDepth > 0)
+        {
+            auto age = m_Network.Now() - Clock::time_point(Clock::duration(oldestEnqueuedAt));
+            snapshot.oldestRequestAge = (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(age).count();
+        }
+
+        return snapshot;
+    }
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "SlippiAuth/Client/ClientStateTable.h"
+#include "SlippiAuth/Client/Network.h"
+
+#include <atomic>
+#include <chrono>
+
+namespace SlippiAuth {
+
+    struct PoolStatusSnapshot
+    {
+        uint32_t idle = 0;
+        uint32_t searching = 0;
+        uint32_t connecting = 0;
+        uint32_t quarantined = 0;
+        // Requests taken from the queue and not finished yet, a client counts from its PreStart
+        uint32_t running = 0;
+        uint32_t queueDepth = 0;
+        // Milliseconds the oldest pending request has been waiting, 0 when the queue is empty
+        uint32_t oldestRequestAge = 0;
+    };
+
+    // Kept up to date by the pool and its clients so it can be read without taking the pool mutex
+    class PoolStatus
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // The ages are measured on the network clock, the one the pool stamps the requests with
+        explicit PoolStatus(Network& network)
+            : m_Network(network) {}
+
+        inline void AddIdle(int32_t delta)
+        {
+            m_Idle.fetch_add(delta, std::memory_order_relaxed);
+        }
+
+        inline void AddQuarantined(int32_t delta)
+        {
+            m_Quarantined.fetch_add(delta, std::memory_order_relaxed);
+        }
+
+        inline void AddRunning(int32_t delta)
+        {
+            m_Running.fetch_add(delta, std::memory_order_relaxed);
+        }
+
+        void OnStateChange(ProcessState from, ProcessState to);
+
+        // Only one thread may write at a time, the pool does it with its mutex held
+        void SetQueue(uint32_t depth, Clock::time_point oldestEnqueuedAt);
+
+        [[nodiscard]] PoolStatusSnapshot Read() const;
+    private:
+        Network& m_Network;
+
+        std::atomic<int32_t> m_Idle{0};
+        std::atomic<int32_t> m_Searching{0};
+        std::atomic<int32_t> m_Connecting{0};
+        std::atomic<int32_t> m_Quarantined{0};
+        std::atomic<int32_t> m_Running{0};
+
+        // Seqlock over the queue fields so they are read together, odd while a write is in progress
+        std::atomic<uint64_t> m_QueueSequence{0};
+        std::atomic<uint32_t> m_QueueDepth{0};
+        std::atomic<Clock::rep> m_OldestEnqueuedAt{0};
+    };
+
+}
@@ -0,0 +1,91 @@
+#include "PortAllocator.h"
+
+#include "SlippiAuth/AppConfig.h"
+
+namespace SlippiAuth {
+
+    PortAllocator::PortAllocator()
+        : m_FirstPort(AppConfig::Value<uint16_t>("ports", "first", 41000)),
+          m_Cooldown(AppConfig::Value("ports", "cooldown", 2000u))
+    {
+        auto lastPort = AppConfig::Value<uint16_t>("ports", "last", 41999);
+        if (lastPort < m_FirstPort)
+        {
+            CORE_ERROR("Invalid port range {}-{}, using {} only", m_FirstPort, lastPort, m_FirstPort);
+            lastPort = m_FirstPort;
+        }
+
+        m_Slots.resize(lastPort - m_FirstPort + 1);
+    }
+
+    PortAllocator& PortAllocator::Get()
+    {
+        static PortAllocator s_Instance;
+        return s_Instance;
+    }
+
+    uint16_t PortAllocator::Acquire(uint16_t owner)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        auto now = Clock::now();
+
+        auto take = [&](size_t index)
+        {
+            auto& slot = m_Slots[index];
+            slot.inUse = true;
+            slot.uses++;
+
+            auto port = (uint16_t)(m_FirstPort + index);
+            m_LastPorts[owner] = port;
+            return port;
+        };
+
+        auto last = m_LastPorts.find(owner);
+        if (last != m_LastPorts.end())
+        {
+            size_t index = last->second - m_FirstPort;
+            // The range may have shrunk since, and a failed port is not worth retrying early
+            if (index < m_Slots.size() && !m_Slots[index].inUse &&
+                (m_Slots[index].freeAt <= now || m_Slots[index].failures == 0))
+                return take(index);
+        }
+
+        for (size_t i = 0; i < m_Slots.size(); i++)
+        {
+            size_t index = (m_Cursor + i) % m_Slots.size();
+            if (!m_Slots[index].inUse && m_Slots[index].freeAt <= now)
+            {
+                m_Cursor = (index + 1) % m_Slots.size();
+                return take(index);
+            }
+        }
+
+        return 0;
+    }
+
+    void PortAllocator::Release(uint16_t port, bool failed)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        size_t index = port - m_FirstPort;
+        if (port < m_FirstPort || index >= m_Slots.size())
+            return;
+
+        auto& slot = m_Slots[index];
+        slot.inUse = false;
+
+        if (failed)
+        {
+            slot.failures++;
+            slot.freeAt = Clock::now() + m_Cooldown * s_FailurePenalty;
+            CORE_WARN("Port {} is unavailable, skipped for {}ms (failed {} out of {} uses)",
+                      port, (m_Cooldown * s_FailurePenalty).count(), slot.failures, slot.uses);
+        }
+        else
+        {
+            slot.failures = 0;
+            slot.freeAt = Clock::now() + m_Cooldown;
+        }
+    }
+
+}
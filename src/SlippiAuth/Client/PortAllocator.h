@@ -0,0 +1,49 @@
+#pragma once
+
+#include "SlippiAuth/Core.h"
+
+#include <chrono>
+#include <mutex>
+
+namespace SlippiAuth {
+
+    // Hands out the local ports of the bot hosts from a configurable range
+    class PortAllocator
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        PortAllocator(const PortAllocator&) = delete;
+
+        static PortAllocator& Get();
+
+        // Returns 0 when every port is in use or cooling down.
+        // The last port of the owner is preferred so a bot keeps the same port when it can.
+        uint16_t Acquire(uint16_t owner);
+
+        // Failed ports could not be bound and cool down longer
+        void Release(uint16_t port, bool failed = false);
+    private:
+        PortAllocator();
+    private:
+        struct Slot
+        {
+            bool inUse = false;
+            Clock::time_point freeAt{};
+            uint32_t uses = 0;
+            uint32_t failures = 0;
+        };
+
+        std::mutex m_Mutex;
+        std::vector<Slot> m_Slots;
+        // Last port of every owner, 0 when it never had one
+        std::unordered_map<uint16_t, uint16_t> m_LastPorts;
+        size_t m_Cursor = 0;
+
+        uint16_t m_FirstPort;
+        std::chrono::milliseconds m_Cooldown;
+
+        static constexpr uint32_t s_FailurePenalty = 10;
+    };
+
+}
@@ -0,0 +1,316 @@
+#include "RequestJournal.h"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace SlippiAuth {
+
+    static int64_t NowMs()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    RequestJournal::RequestJournal(std::string path, size_t capacity, std::chrono::milliseconds flushInterval)
+        : m_Path(std::move(path)), m_Capacity(std::max(capacity, (size_t)64)), m_FlushInterval(flushInterval)
+    {
+        // No path, no journal
+        if (m_Path.empty())
+            return;
+
+        size_t size = m_Capacity * sizeof(Record);
+
+        // The previous process keeps its journal until it has drained, the other file is free then
+        std::string mainPath = m_Path;
+        m_Fd = OpenLocked(mainPath);
+        if (m_Fd < 0)
+        {
+            m_Path = mainPath + s_HandOffSuffix;
+            m_Fd = OpenLocked(m_Path);
+            if (m_Fd >= 0)
+                CORE_WARN("The request journal {} is held by another process, using {}", mainPath, m_Path);
+        }
+
+        if (m_Fd < 0 || ftruncate(m_Fd, (off_t)size) != 0)
+        {
+            CORE_ERROR("Cannot open or lock the request journal {}, requests will not survive a crash", m_Path);
+            return;
+        }
+
+        void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_Fd, 0);
+        if (memory == MAP_FAILED)
+        {
+            CORE_ERROR("Cannot map the request journal {}, requests will not survive a crash", m_Path);
+            return;
+        }
+        m_Records = static_cast<Record*>(memory);
+
+        Recover(m_Records, m_Capacity);
+
+        // The other file is only free if the process that used it is gone
+        std::string otherPath = m_Path == mainPath ? mainPath + s_HandOffSuffix : mainPath;
+        int otherFd = OpenLocked(otherPath);
+        if (otherFd >= 0)
+            RecoverAbandoned(otherFd, otherPath);
+
+        // Both files can hold requests, queue them again in the order they were accepted
+        std::stable_sort(m_Recovered.begin(), m_Recovered.end(), [](const auto& a, const auto& b)
+        {
+            return a.acceptedAt < b.acceptedAt;
+        });
+
+        if (!m_Recovered.empty())
+            CORE_WARN("The request journal holds {} unfinished requests", m_Recovered.size());
+
+        m_FlushThread = std::thread([this]() { RunFlusher(); });
+    }
+
+    RequestJournal::~RequestJournal()
+    {
+        if (m_FlushThread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_FlushMutex);
+                m_Stopping = true;
+            }
+            m_FlushCondition.notify_all();
+            m_FlushThread.join();
+        }
+
+        if (m_Records)
+        {
+            msync(m_Records, m_Capacity * sizeof(Record), MS_SYNC);
+            munmap(m_Records, m_Capacity * sizeof(Record));
+        }
+
+        if (m_Fd >= 0)
+            close(m_Fd);
+    }
+
+    uint32_t RequestJournal::Checksum(const Record& record)
+    {
+        // FNV-1a over the record with an empty checksum, enough to spot a torn write
+        Record copy = record;
+        copy.checksum = 0;
+
+        uint32_t hash = 2166136261u;
+        auto* bytes = reinterpret_cast<const uint8_t*>(&copy);
+        for (size_t i = 0; i < sizeof(Record); i++)
+        {
+            hash ^= bytes[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    int RequestJournal::OpenLocked(const std::string& path)
+    {
+        int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0)
+            return -1;
+
+        // Released by the kernel when the process exits, even after a crash
+        if (flock(fd, LOCK_EX | LOCK_NB) != 0)
+        {
+            close(fd);
+            return -1;
+        }
+
+        return fd;
+    }
+
+    void RequestJournal::RecoverAbandoned(int fd, const std::string& path)
+    {
+        struct stat info{};
+        size_t capacity = fstat(fd, &info) == 0 ? (size_t)info.st_size / sizeof(Record) : 0;
+
+        if (capacity > 0)
+        {
+            void* memory = mmap(nullptr, capacity * sizeof(Record), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (memory != MAP_FAILED)
+            {
+                Recover(static_cast<Record*>(memory), capacity);
+                munmap(memory, capacity * sizeof(Record));
+            }
+            else
+            {
+                CORE_ERROR("Cannot map the request journal {}, its requests are not recovered", path);
+            }
+        }
+
+        // Unlocked so the next process taking over can use it
+        close(fd);
+    }
+
+    void RequestJournal::Recover(Record* records, size_t capacity)
+    {
+        std::unordered_map<uint64_t, JournalEntry> unfinished;
+        std::vector<uint64_t> order;
+
+        // The journal ends at the first record that was never written completely
+        for (size_t i = 0; i < capacity; i++)
+        {
+            const Record& record = records[i];
+            if (record.magic != s_Magic || record.checksum != Checksum(record))
+                break;
+
+            switch (record.type)
+            {
+                case RecordType::Accepted:
+                {
+                    std::string connectCode(record.connectCode, strnlen(record.connectCode, sizeof(record.connectCode)));
+                    unfinished[record.requestId] = {
+                        record.requestId,
+                        record.discordId,
+                        connectCode,
+                        record.timeout,
+                        (QueuePriority)record.priority,
+                        record.time,
+                        std::nullopt
+                    };
+                    order.push_back(record.requestId);
+                    break;
+                }
+                case RecordType::Started:
+                {
+                    auto iter = unfinished.find(record.requestId);
+                    if (iter != unfinished.end())
+                        iter->second.startedBy = record.clientId;
+                    break;
+                }
+                case RecordType::Completed:
+                    unfinished.erase(record.requestId);
+                    break;
+            }
+        }
+
+        for (uint64_t requestId : order)
+        {
+            auto iter = unfinished.find(requestId);
+            if (iter != unfinished.end())
+            {
+                m_Recovered.push_back(std::move(iter->second));
+                unfinished.erase(iter);
+            }
+        }
+
+        // The recovered requests are journaled again once the pool takes them back
+        std::memset(records, 0, capacity * sizeof(Record));
+        msync(records, capacity * sizeof(Record), MS_SYNC);
+    }
+
+    void RequestJournal::Accepted(uint64_t requestId, uint64_t discordId, const std::string& connectCode,
+                                  uint32_t timeout, QueuePriority priority)
+    {
+        if (!m_Records)
+            return;
+
+        Record record{};
+        record.type = RecordType::Accepted;
+        record.priority = (uint8_t)priority;
+        record.timeout = timeout;
+        record.requestId = requestId;
+        record.discordId = discordId;
+        record.time = NowMs();
+        connectCode.copy(record.connectCode, sizeof(record.connectCode) - 1);
+
+        // Added after the append, a compaction it triggers must not write the record twice
+        Append(record);
+        m_Open[requestId] = {record, std::nullopt};
+    }
+
+    void RequestJournal::Started(uint64_t requestId, uint16_t clientId)
+    {
+        if (!m_Records)
+            return;
+
+        Record record{};
+        record.type = RecordType::Started;
+        record.clientId = clientId;
+        record.requestId = requestId;
+        record.time = NowMs();
+
+        Append(record);
+
+        auto iter = m_Open.find(requestId);
+        if (iter != m_Open.end())
+            iter->second.started = record;
+    }
+
+    void RequestJournal::Completed(uint64_t requestId)
+    {
+        if (!m_Records)
+            return;
+
+        m_Open.erase(requestId);
+
+        Record record{};
+        record.type = RecordType::Completed;
+        record.requestId = requestId;
+        record.time = NowMs();
+
+        Append(record);
+    }
+
+    void RequestJournal::Append(Record record)
+    {
+        if (m_Next == m_Capacity)
+            Compact();
+
+        // Still full of unfinished requests, they are already journaled
+        if (m_Next == m_Capacity)
+            return;
+
+        record.magic = s_Magic;
+        record.checksum = Checksum(record);
+        m_Records[m_Next++] = record;
+
+        m_Dirty.store(true, std::memory_order_release);
+    }
+
+    void RequestJournal::Compact()
+    {
+        m_Next = 0;
+        for (auto& [requestId, request] : m_Open)
+        {
+            // A started request is recovered as started, its Started record follows the Accepted one
+            size_t needed = request.started ? 2 : 1;
+            if (m_Capacity - m_Next < needed)
+            {
+                CORE_ERROR("The request journal is too small for {} pending requests", m_Open.size());
+                break;
+            }
+
+            auto write = [this](Record record)
+            {
+                record.magic = s_Magic;
+                record.checksum = Checksum(record);
+                m_Records[m_Next++] = record;
+            };
+
+            write(request.accepted);
+            if (request.started)
+                write(*request.started);
+        }
+
+        std::memset(m_Records + m_Next, 0, (m_Capacity - m_Next) * sizeof(Record));
+        m_Dirty.store(true, std::memory_order_release);
+    }
+
+    void RequestJournal::RunFlusher()
+    {
+        std::unique_lock<std::mutex> lock(m_FlushMutex);
+        while (!m_Stopping)
+        {
+            m_FlushCondition.wait_for(lock, m_FlushInterval);
+
+            // Every record written since the last round is flushed at once
+            if (m_Dirty.exchange(false, std::memory_order_acquire))
+                msync(m_Records, m_Capacity * sizeof(Record), MS_ASYNC);
+        }
+    }
+
+}
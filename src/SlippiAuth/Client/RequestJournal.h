@@ -0,0 +1,121 @@
+#pragma once
+
+#include "SlippiAuth/Events/ServerEvent.h"
+#include "SlippiAuth/Core.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+namespace SlippiAuth {
+
+    // A request the previous process accepted but never finished
+    struct JournalEntry
+    {
+        uint64_t requestId;
+        uint64_t discordId;
+        std::string connectCode;
+        uint32_t timeout;
+        QueuePriority priority;
+        // System clock, in milliseconds since epoch
+        int64_t acceptedAt;
+        // Client of the previous process searching for it, the user already got its connect code
+        std::optional<uint16_t> startedBy;
+    };
+
+    // Append-only memory mapped log of the requests of the pool, so they survive a crash.
+    // Records land in the page cache as soon as they are written, a background thread flushes them to disk in batches.
+    // The file is locked while in use, a process taking over with SO_REUSEPORT uses a second one until the next restart.
+    class RequestJournal
+    {
+    public:
+        RequestJournal(std::string path, size_t capacity, std::chrono::milliseconds flushInterval);
+        RequestJournal(const RequestJournal&) = delete;
+        ~RequestJournal();
+
+        [[nodiscard]] bool IsOpen() const
+        {
+            return m_Records != nullptr;
+        }
+
+        // Unfinished requests found when the journal was opened, the journal starts empty again
+        std::vector<JournalEntry> TakeRecovered()
+        {
+            return std::move(m_Recovered);
+        }
+
+        // Not thread safe, the pool calls them with its mutex held
+        void Accepted(uint64_t requestId, uint64_t discordId, const std::string& connectCode,
+                      uint32_t timeout, QueuePriority priority);
+        void Started(uint64_t requestId, uint16_t clientId);
+        void Completed(uint64_t requestId);
+    private:
+        enum class RecordType : uint8_t
+        {
+            Accepted = 1,
+            Started,
+            Completed,
+        };
+
+        struct Record
+        {
+            uint32_t magic;
+            RecordType type;
+            uint8_t priority;
+            uint16_t clientId;
+            uint32_t timeout;
+            uint32_t checksum;
+            uint64_t requestId;
+            uint64_t discordId;
+            int64_t time;
+            char connectCode[16];
+            uint8_t padding[8];
+        };
+        static_assert(sizeof(Record) == 64, "Journal records must stay 64 bytes");
+
+        // Accepted record of an unfinished request, and its Started record once handed to a client
+        struct OpenRequest
+        {
+            Record accepted;
+            std::optional<Record> started;
+        };
+
+        static uint32_t Checksum(const Record& record);
+        // Opens the file and locks it, -1 if it cannot be opened or another process holds it
+        static int OpenLocked(const std::string& path);
+
+        // Takes the unfinished requests of a journal file and clears it
+        void Recover(Record* records, size_t capacity);
+        // Recovers a journal file left unlocked by a process that is gone, without keeping it
+        void RecoverAbandoned(int fd, const std::string& path);
+        void Append(Record record);
+        // Rewrites the unfinished requests at the start of the journal
+        void Compact();
+
+        void RunFlusher();
+    private:
+        std::string m_Path;
+        size_t m_Capacity;
+        int m_Fd = -1;
+        Record* m_Records = nullptr;
+        size_t m_Next = 0;
+
+        // Records of the requests not completed yet, to compact the journal
+        std::unordered_map<uint64_t, OpenRequest> m_Open;
+        std::vector<JournalEntry> m_Recovered;
+
+        std::chrono::milliseconds m_FlushInterval;
+        std::atomic<bool> m_Dirty = false;
+        std::mutex m_FlushMutex;
+        std::condition_variable m_FlushCondition;
+        bool m_Stopping = false;
+        std::thread m_FlushThread;
+
+        static constexpr uint32_t s_Magic = 0x314A4153; // "SAJ1"
+        // Appended to the path of the journal used while the previous process still holds the main one
+        static constexpr const char* s_HandOffSuffix = ".1";
+    };
+
+}
@@ -0,0 +1,21 @@
+#include "SlippiEndpoints.h"
+
+#include "SlippiAuth/AppConfig.h"
+
+namespace SlippiAuth {
+
+    const SlippiEndpoints& SlippiEndpoints::Get()
+    {
+        static const SlippiEndpoints s_Endpoints = []()
+        {
+            SlippiEndpoints endpoints;
+            endpoints.matchmakingHost = AppConfig::Value("slippi", "matchmakingHost", endpoints.matchmakingHost);
+            endpoints.matchmakingPort = AppConfig::Value("slippi", "matchmakingPort", endpoints.matchmakingPort);
+            endpoints.apiBaseUrl = AppConfig::Value("slippi", "apiBaseUrl", endpoints.apiBaseUrl);
+            return endpoints;
+        }();
+
+        return s_Endpoints;
+    }
+
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "SlippiAuth/Core.h"
+
+namespace SlippiAuth {
+
+    // Where the clients reach the Slippi services, shared by every client
+    struct SlippiEndpoints
+    {
+        std::string matchmakingHost = "mm.slippi.gg";
+        uint16_t matchmakingPort = 43113;
+        std::string apiBaseUrl = "https://users-rest-dot-slippi.uc.r.appspot.com/user";
+
+        // Read once from the "slippi" section of the app config
+        static const SlippiEndpoints& Get();
+    };
+
+}
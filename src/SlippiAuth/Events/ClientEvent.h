@@ -7,8 +7,10 @@ namespace SlippiAuth {
     class SearchingEvent : public Event
     {
     public:
-        explicit SearchingEvent(uint64_t discordId, std::string botConnectCode, std::string userConnectCode)
+        explicit SearchingEvent(uint64_t discordId, uint64_t requestId, std::string botConnectCode,
+                                std::string userConnectCode)
             : m_DiscordId(discordId),
+            m_RequestId(requestId),
             m_UserConnectCode(std::move(userConnectCode)),
             m_BotConnectCode(std::move(botConnectCode)) {};
 
@@ -17,6 +19,11 @@ namespace SlippiAuth {
             return m_DiscordId;
         }
 
+        [[nodiscard]] inline uint64_t GetRequestId() const
+        {
+            return m_RequestId;
+        }
+
         inline const std::string& GetUserConnectCode()
         {
             return m_UserConnectCode;
@@ -30,7 +37,7 @@ namespace SlippiAuth {
         [[nodiscard]] std::string ToString() const override
         {
             std::stringstream ss;
-            ss << "SearchingEvent: " << "(" << m_DiscordId << ", " << m_BotConnectCode
+            ss << "SearchingEvent: " << "(" << m_DiscordId << ", " << m_RequestId << ", " << m_BotConnectCode
                << ", " << m_UserConnectCode << ")";
             return ss.str();
         }
@@ -39,6 +46,7 @@ namespace SlippiAuth {
         EVENT_CLASS_TYPE(Searching);
     private:
         uint64_t m_DiscordId;
+        uint64_t m_RequestId;
         std::string m_BotConnectCode;
         std::string m_UserConnectCode;
     };
@@ -154,4 +162,36 @@ namespace SlippiAuth {
         std::string m_UserConnectCode;
     };
 
+    class CancelledEvent : public Event
+    {
+    public:
+        explicit CancelledEvent(uint64_t discordId, std::string userConnectCode)
+                : m_DiscordId(discordId),
+                  m_UserConnectCode(std::move(userConnectCode)) {};
+
+        [[nodiscard]] inline uint64_t GetDiscordId() const
+        {
+            return m_DiscordId;
+        }
+
+        inline const std::string& GetUserConnectCode()
+        {
+            return m_UserConnectCode;
+        }
+
+        [[nodiscard]] std::string ToString() const override
+        {
+            std::stringstream ss;
+            ss << "CancelledEvent: " << "(" << m_DiscordId
+               << ", " << m_UserConnectCode << ")";
+            return ss.str();
+        }
+
+        EVENT_CLASS_CATEGORY(EventCategoryClient);
+        EVENT_CLASS_TYPE(Cancelled);
+    private:
+        uint64_t m_DiscordId;
+        std::string m_UserConnectCode;
+    };
+
 }
@@ -36,4 +36,119 @@ namespace SlippiAuth
         std::string m_UserConnectCode;
     };
 
-}
+    class QueuedEvent : public Event
+    {
+    public:
+        explicit QueuedEvent(uint64_t discordId, uint64_t requestId, std::string userConnectCode, size_t position)
+            : m_DiscordId(discordId),
+            m_RequestId(requestId),
+            m_UserConnectCode(std::move(userConnectCode)),
+            m_Position(position) {}
+
+        [[nodiscard]] inline uint64_t GetDiscordId() const
+        {
+            return m_DiscordId;
+        }
+
+        [[nodiscard]] inline uint64_t GetRequestId() const
+        {
+            return m_RequestId;
+        }
+
+        inline const std::string& GetUserConnectCode()
+        {
+            return m_UserConnectCode;
+        }
+
+        [[nodiscard]] inline size_t GetPosition() const
+        {
+            return m_Position;
+        }
+
+        [[nodiscard]] std::string ToString() const override
+        {
+            std::stringstream ss;
+            ss << "QueuedEvent: (" << m_DiscordId << ", " << m_RequestId << ", " << m_UserConnectCode << ", " << m_Position << ")";
+            return ss.str();
+        }
+
+        EVENT_CLASS_CATEGORY(EventCategoryClientPool);
+        EVENT_CLASS_TYPE(Queued);
+    private:
+        uint64_t m_DiscordId;
+        uint64_t m_RequestId;
+        std::string m_UserConnectCode;
+        size_t m_Position;
+    };
+
+    class UpstreamDownEvent : public Event
+    {
+    public:
+        explicit UpstreamDownEvent(uint64_t discordId, std::string userConnectCode, uint32_t retryAfter)
+            : m_DiscordId(discordId),
+            m_UserConnectCode(std::move(userConnectCode)),
+            m_RetryAfter(retryAfter) {}
+
+        [[nodiscard]] inline uint64_t GetDiscordId() const
+        {
+            return m_DiscordId;
+        }
+
+        inline const std::string& GetUserConnectCode()
+        {
+            return m_UserConnectCode;
+        }
+
+        [[nodiscard]] inline uint32_t GetRetryAfter() const
+        {
+            return m_RetryAfter;
+        }
+
+        [[nodiscard]] std::string ToString() const override
+        {
+            std::stringstream ss;
+            ss << "UpstreamDownEvent: (" << m_DiscordId << ", " << m_UserConnectCode << ", " << m_RetryAfter << ")";
+            return ss.str();
+        }
+
+        EVENT_CLASS_CATEGORY(EventCategoryClientPool);
+        EVENT_CLASS_TYPE(UpstreamDown);
+    private:
+        uint64_t m_DiscordId;
+        std::string m_UserConnectCode;
+        uint32_t m_RetryAfter;
+    };
+
+    // A request lost in a crash, found in the journal too late to be served
+    class AbortedEvent : public Event
+    {
+    public:
+        explicit AbortedEvent(uint64_t discordId, std::string userConnectCode)
+            : m_DiscordId(discordId),
+            m_UserConnectCode(std::move(userConnectCode)) {}
+
+        [[nodiscard]] inline uint64_t GetDiscordId() const
+        {
+            return m_DiscordId;
+        }
+
+        inline const std::string& GetUserConnectCode()
+        {
+            return m_UserConnectCode;
+        }
+
+        [[nodiscard]] std::string ToString() const override
+        {
+            std::stringstream ss;
+            ss << "AbortedEvent: (" << m_DiscordId << ", " << m_UserConnectCode << ")";
+            return ss.str();
+        }
+
+        EVENT_CLASS_CATEGORY(EventCategoryClientPool);
+        EVENT_CLASS_TYPE(Aborted);
+    private:
+        uint64_t m_DiscordId;
+        std::string m_UserConnectCode;
+    };
+
+}
\ No newline at end of file
@@ -15,6 +15,12 @@ namespace SlippiAuth {
         Timeout,
         SlippiError,
         NoReadyClient,
+        Queued,
+        Cancel,
+        Cancelled,
+        UpstreamDown,
+        Status,
+        Aborted,
     };
 
     enum EventCategory
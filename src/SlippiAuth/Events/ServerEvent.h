@@ -1,16 +1,30 @@
 #pragma once
 
 #include "Event.h"
+#include "SlippiAuth/Client/PoolStatus.h"
+
+#include <optional>
 
 namespace SlippiAuth {
 
+    // Lanes of the client pool scheduler, ordered from lowest to highest priority
+    enum class QueuePriority
+    {
+        Normal = 0,
+        High,
+    };
+
+    constexpr size_t QueuePriorityCount = 2;
+
     class QueueEvent : public Event
     {
     public:
-        explicit QueueEvent(std::string userConnectCode, uint32_t timeout, uint64_t discordId)
+        explicit QueueEvent(std::string userConnectCode, uint32_t timeout, uint64_t discordId,
+                            QueuePriority priority = QueuePriority::Normal)
             : m_UserConnectCode(std::move(userConnectCode)),
             m_Timeout(timeout),
-            m_DiscordId(discordId) {}
+            m_DiscordId(discordId),
+            m_Priority(priority) {}
 
         inline const std::string& GetUserConnectCode()
         {
@@ -27,10 +41,16 @@ namespace SlippiAuth {
             return m_DiscordId;
         }
 
+        [[nodiscard]] inline QueuePriority GetPriority() const
+        {
+            return m_Priority;
+        }
+
         [[nodiscard]] std::string ToString() const override
         {
             std::stringstream ss;
-            ss << "QueueEvent: (" << m_DiscordId << m_UserConnectCode << ", " << m_Timeout << ")";
+            ss << "QueueEvent: (" << m_DiscordId << ", " << m_UserConnectCode << ", " << m_Timeout
+               << ", " << (m_Priority == QueuePriority::High ? "high" : "normal") << ")";
             return ss.str();
         }
 
@@ -40,6 +60,76 @@ namespace SlippiAuth {
         std::string m_UserConnectCode;
         uint32_t m_Timeout;
         uint64_t m_DiscordId;
+        QueuePriority m_Priority;
+    };
+
+    class CancelEvent : public Event
+    {
+    public:
+        // Without a request id every request of the user is cancelled
+        explicit CancelEvent(uint64_t discordId, std::optional<uint64_t> requestId = std::nullopt)
+            : m_DiscordId(discordId), m_RequestId(requestId) {}
+
+        [[nodiscard]] inline uint64_t GetDiscordId() const
+        {
+            return m_DiscordId;
+        }
+
+        [[nodiscard]] inline std::optional<uint64_t> GetRequestId() const
+        {
+            return m_RequestId;
+        }
+
+        // Whether a request of the user is one this event cancels
+        [[nodiscard]] inline bool Matches(uint64_t discordId, uint64_t requestId) const
+        {
+            return discordId == m_DiscordId && (!m_RequestId || *m_RequestId == requestId);
+        }
+
+        [[nodiscard]] std::string ToString() const override
+        {
+            std::stringstream ss;
+            ss << "CancelEvent: (" << m_DiscordId;
+            if (m_RequestId)
+                ss << ", " << *m_RequestId;
+            ss << ")";
+            return ss.str();
+        }
+
+        EVENT_CLASS_CATEGORY(EventCategoryServer);
+        EVENT_CLASS_TYPE(Cancel);
+    private:
+        uint64_t m_DiscordId;
+        std::optional<uint64_t> m_RequestId;
+    };
+
+    // Filled by the pool while it is dispatched
+    class StatusEvent : public Event
+    {
+    public:
+        StatusEvent() = default;
+
+        [[nodiscard]] inline const PoolStatusSnapshot& GetSnapshot() const
+        {
+            return m_Snapshot;
+        }
+
+        inline void SetSnapshot(const PoolStatusSnapshot& snapshot)
+        {
+            m_Snapshot = snapshot;
+        }
+
+        [[nodiscard]] std::string ToString() const override
+        {
+            std::stringstream ss;
+            ss << "StatusEvent: (" << m_Snapshot.idle << " idle, " << m_Snapshot.queueDepth << " queued)";
+            return ss.str();
+        }
+
+        EVENT_CLASS_CATEGORY(EventCategoryServer);
+        EVENT_CLASS_TYPE(Status);
+    private:
+        PoolStatusSnapshot m_Snapshot;
     };
 
-}
\ No newline at end of file
+}
@@ -1,27 +1,134 @@
 #include "Log.h"
 
+#include <spdlog/pattern_formatter.h>
+
+#include <nlohmann/json.hpp>
+
 namespace SlippiAuth {
 
-    std::vector<std::shared_ptr<spdlog::logger>> Log::s_ClientLoggers;
+    std::shared_ptr<spdlog::logger> Log::s_ClientLogger;
     std::shared_ptr<spdlog::logger> Log::s_CoreLogger;
     std::shared_ptr<spdlog::logger> Log::s_ServerLogger;
 
-    void Log::Init(size_t clientPoolSize)
+    std::atomic<spdlog::level::level_enum> Log::s_ClientLevel = spdlog::level::trace;
+    std::atomic<bool> Log::s_HasClientOverrides = false;
+    std::shared_mutex Log::s_ClientOverridesMutex;
+    std::unordered_map<uint16_t, spdlog::level::level_enum> Log::s_ClientOverrides;
+
+    thread_local int32_t Log::s_CurrentClient = -1;
+
+    // %* in a pattern, the id of the client that logged the message
+    class ClientIdFlag : public spdlog::custom_flag_formatter
+    {
+    public:
+        void format(const spdlog::details::log_msg&, const std::tm&, spdlog::memory_buf_t& dest) override
+        {
+            int32_t client = Log::GetCurrentClient();
+            if (client >= 0)
+                fmt::format_to(std::back_inserter(dest), " {}", client);
+        }
+
+        [[nodiscard]] std::unique_ptr<custom_flag_formatter> clone() const override
+        {
+            return spdlog::details::make_unique<ClientIdFlag>();
+        }
+    };
+
+    // One json object per line, for log collectors
+    class JsonLineFormatter : public spdlog::formatter
     {
-        // Allocate enough memory to hold all the loggers
-        s_ClientLoggers.reserve(clientPoolSize);
+    public:
+        void format(const spdlog::details::log_msg& msg, spdlog::memory_buf_t& dest) override
+        {
+            auto time = std::chrono::duration_cast<std::chrono::milliseconds>(msg.time.time_since_epoch());
+
+            nlohmann::json line = {
+                    {"time", time.count()},
+                    {"level", spdlog::level::to_string_view(msg.level)},
+                    {"logger", msg.logger_name},
+                    {"msg", msg.payload}
+            };
+
+            int32_t client = Log::GetCurrentClient();
+            if (client >= 0)
+                line["client"] = client;
 
-        for (int index = 0; index < clientPoolSize; index++)
+            auto text = line.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+            dest.append(text.data(), text.data() + text.size());
+            dest.push_back('\n');
+        }
+
+        [[nodiscard]] std::unique_ptr<spdlog::formatter> clone() const override
         {
-            s_ClientLoggers.emplace_back(spdlog::stdout_color_mt("CLIENT " + std::to_string(index)));
-            s_ClientLoggers[index]->set_level(spdlog::level::trace);
+            return spdlog::details::make_unique<JsonLineFormatter>();
         }
+    };
+
+    void Log::Init(bool jsonLines)
+    {
+        s_ClientLogger = spdlog::stdout_color_mt("CLIENT");
+        s_ClientLogger->set_level(spdlog::level::trace);
 
         s_CoreLogger = spdlog::stdout_color_mt("CORE");
         s_CoreLogger->set_level(spdlog::level::trace);
 
         s_ServerLogger = spdlog::stdout_color_mt("SERVER");
         s_ServerLogger->set_level(spdlog::level::trace);
+
+        if (jsonLines)
+        {
+            for (auto& logger : {s_ClientLogger, s_CoreLogger, s_ServerLogger})
+                logger->set_formatter(spdlog::details::make_unique<JsonLineFormatter>());
+        }
+        else
+        {
+            // Same lines as the default pattern, the client id follows the logger name
+            auto formatter = spdlog::details::make_unique<spdlog::pattern_formatter>();
+            formatter->add_flag<ClientIdFlag>('*').set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%n%*] [%^%l%$] %v");
+            s_ClientLogger->set_formatter(std::move(formatter));
+        }
+    }
+
+    void Log::SetClientLevel(spdlog::level::level_enum level)
+    {
+        s_ClientLevel = level;
+        UpdateClientLoggerLevel();
+    }
+
+    void Log::SetClientLevel(uint16_t client, spdlog::level::level_enum level)
+    {
+        {
+            std::unique_lock lock(s_ClientOverridesMutex);
+            s_ClientOverrides[client] = level;
+        }
+
+        s_HasClientOverrides = true;
+        UpdateClientLoggerLevel();
+    }
+
+    bool Log::ShouldLogClientOverride(uint16_t client, spdlog::level::level_enum level)
+    {
+        std::shared_lock lock(s_ClientOverridesMutex);
+
+        auto iter = s_ClientOverrides.find(client);
+        if (iter != s_ClientOverrides.end())
+            return level >= iter->second;
+
+        return level >= s_ClientLevel.load(std::memory_order_relaxed);
+    }
+
+    void Log::UpdateClientLoggerLevel()
+    {
+        // The logger lets through what any client may log, the macros filter per client
+        auto level = s_ClientLevel.load();
+        {
+            std::shared_lock lock(s_ClientOverridesMutex);
+            for (auto& [client, clientLevel] : s_ClientOverrides)
+                level = std::min(level, clientLevel);
+        }
+
+        if (s_ClientLogger)
+            s_ClientLogger->set_level(level);
     }
 
 }
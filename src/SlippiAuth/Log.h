@@ -4,21 +4,58 @@
 #include <spdlog/fmt/ostr.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 
+#include <atomic>
+#include <shared_mutex>
+#include <unordered_map>
+
 namespace SlippiAuth {
 
     class Log
     {
     public:
-        static void Init(size_t clientPoolSize);
+        // Json lines carry the client id as their own field instead of the text prefix
+        static void Init(bool jsonLines = false);
 
-        inline static std::shared_ptr<spdlog::logger>& GetClientLogger(size_t core) { return s_ClientLoggers[core]; }
+        inline static std::shared_ptr<spdlog::logger>& GetClientLogger() { return s_ClientLogger; }
         inline static std::shared_ptr<spdlog::logger>& GetCoreLogger() { return s_CoreLogger; }
         inline static std::shared_ptr<spdlog::logger>& GetServerLogger() { return s_ServerLogger; }
 
+        // Level of the clients without an override
+        static void SetClientLevel(spdlog::level::level_enum level);
+        // Only the clients being looked at pay for an override
+        static void SetClientLevel(uint16_t client, spdlog::level::level_enum level);
+
+        inline static bool ShouldLogClient(uint16_t client, spdlog::level::level_enum level)
+        {
+            if (s_HasClientOverrides.load(std::memory_order_relaxed))
+                return ShouldLogClientOverride(client, level);
+
+            return level >= s_ClientLevel.load(std::memory_order_relaxed);
+        }
+
+        // Tags the messages logged by this thread with the client id
+        class ClientScope
+        {
+        public:
+            explicit ClientScope(uint16_t client) { s_CurrentClient = client; }
+            ~ClientScope() { s_CurrentClient = -1; }
+        };
+
+        [[nodiscard]] inline static int32_t GetCurrentClient() { return s_CurrentClient; }
     private:
-        static std::vector<std::shared_ptr<spdlog::logger>> s_ClientLoggers;
+        static bool ShouldLogClientOverride(uint16_t client, spdlog::level::level_enum level);
+        static void UpdateClientLoggerLevel();
+    private:
+        static std::shared_ptr<spdlog::logger> s_ClientLogger;
         static std::shared_ptr<spdlog::logger> s_CoreLogger;
         static std::shared_ptr<spdlog::logger> s_ServerLogger;
+
+        static std::atomic<spdlog::level::level_enum> s_ClientLevel;
+        static std::atomic<bool> s_HasClientOverrides;
+        static std::shared_mutex s_ClientOverridesMutex;
+        static std::unordered_map<uint16_t, spdlog::level::level_enum> s_ClientOverrides;
+
+        static thread_local int32_t s_CurrentClient;
     };
 
 }
@@ -29,11 +66,20 @@ namespace SlippiAuth {
 #define CORE_WARN(...)  ::SlippiAuth::Log::GetCoreLogger()->warn(__VA_ARGS__)
 #define CORE_ERROR(...) ::SlippiAuth::Log::GetCoreLogger()->error(__VA_ARGS__)
 
-// Clients logs macro
-#define CLIENT_TRACE(client,...)  ::SlippiAuth::Log::GetClientLogger(client)->trace(__VA_ARGS__)
-#define CLIENT_INFO(client, ...)  ::SlippiAuth::Log::GetClientLogger(client)->info(__VA_ARGS__)
-#define CLIENT_WARN(client, ...)  ::SlippiAuth::Log::GetClientLogger(client)->warn(__VA_ARGS__)
-#define CLIENT_ERROR(client, ...) ::SlippiAuth::Log::GetClientLogger(client)->error(__VA_ARGS__)
+// Clients logs macro, every client shares one logger
+#define CLIENT_LOG(client, level, ...) \
+    do { \
+        if (::SlippiAuth::Log::ShouldLogClient(client, level)) \
+        { \
+            ::SlippiAuth::Log::ClientScope clientScope(client); \
+            ::SlippiAuth::Log::GetClientLogger()->log(level, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define CLIENT_TRACE(client, ...) CLIENT_LOG(client, spdlog::level::trace, __VA_ARGS__)
+#define CLIENT_INFO(client, ...)  CLIENT_LOG(client, spdlog::level::info, __VA_ARGS__)
+#define CLIENT_WARN(client, ...)  CLIENT_LOG(client, spdlog::level::warn, __VA_ARGS__)
+#define CLIENT_ERROR(client, ...) CLIENT_LOG(client, spdlog::level::err, __VA_ARGS__)
 
 // Websocket logs macro
 #define SERVER_TRACE(...) ::SlippiAuth::Log::GetServerLogger()->trace(__VA_ARGS__)
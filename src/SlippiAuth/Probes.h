@@ -0,0 +1,16 @@
+#pragma once
+
+// USDT probes, a single nop until a tracer attaches to them:
+//   bpftrace -l 'usdt:./SlippiAuth:slippiauth:*'
+// Built when CMake finds sys/sdt.h, otherwise they compile to nothing.
+#ifdef SLIPPIAUTH_USDT
+
+#include <sys/sdt.h>
+
+#define SLIPPIAUTH_PROBE(name, ...) STAP_PROBEV(slippiauth, name, __VA_ARGS__)
+
+#else
+
+#define SLIPPIAUTH_PROBE(name, ...) do {} while (0)
+
+#endif
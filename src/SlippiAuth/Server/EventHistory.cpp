@@ -0,0 +1,51 @@
+#include "EventHistory.h"
+
+#include <random>
+
+namespace SlippiAuth {
+
+    EventHistory::EventHistory(size_t capacity)
+        : m_Payloads(std::max(capacity, (size_t)1))
+    {
+        // Mixed with the time in case random_device is deterministic on this platform
+        std::random_device device;
+        uint64_t epoch = ((uint64_t)device() << 32) | device();
+        epoch ^= (uint64_t)std::chrono::system_clock::now().time_since_epoch().count();
+        m_Epoch = fmt::format("{:016x}", epoch);
+    }
+
+    std::string EventHistory::Append(Json& message)
+    {
+        uint64_t seq = m_NextSeq++;
+        message["epoch"] = m_Epoch;
+        message["seq"] = seq;
+
+        auto& payload = m_Payloads[seq % m_Payloads.size()];
+        payload = message.dump();
+        return payload;
+    }
+
+    bool EventHistory::Since(const std::string& epoch, uint64_t lastSeq, std::string& events) const
+    {
+        uint64_t oldestSeq = m_NextSeq > m_Payloads.size() ? m_NextSeq - m_Payloads.size() : 1;
+
+        // A sequence number from another process says nothing about what was seen here,
+        // send everything we have
+        bool sameEpoch = epoch == m_Epoch && lastSeq < m_NextSeq;
+        bool complete = sameEpoch && lastSeq + 1 >= oldestSeq;
+        uint64_t firstSeq = sameEpoch ? std::max(lastSeq + 1, oldestSeq) : oldestSeq;
+
+        // The payloads are already serialized, join them instead of building a json array
+        events = "[";
+        for (uint64_t seq = firstSeq; seq < m_NextSeq; seq++)
+        {
+            if (seq != firstSeq)
+                events += ',';
+            events += m_Payloads[seq % m_Payloads.size()];
+        }
+        events += ']';
+
+        return complete;
+    }
+
+}
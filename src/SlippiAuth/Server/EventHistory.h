@@ -0,0 +1,38 @@
+#pragma once
+
+#include "SlippiAuth/Core.h"
+
+namespace SlippiAuth {
+
+    // Last events sent to the websocket clients, so a reconnecting client can catch up
+    class EventHistory
+    {
+    public:
+        explicit EventHistory(size_t capacity);
+
+        // Stamps the message with the epoch and the next sequence number and keeps its payload
+        std::string Append(Json& message);
+
+        // Json array of the events after lastSeq, in order.
+        // Returns false if some of them were already dropped from the history,
+        // or if lastSeq comes from another epoch, in which case everything kept is sent.
+        bool Since(const std::string& epoch, uint64_t lastSeq, std::string& events) const;
+
+        [[nodiscard]] const std::string& GetEpoch() const
+        {
+            return m_Epoch;
+        }
+
+        [[nodiscard]] uint64_t GetLastSeq() const
+        {
+            return m_NextSeq - 1;
+        }
+    private:
+        std::vector<std::string> m_Payloads;
+        // Random for every process, sequence numbers only mean something within an epoch
+        std::string m_Epoch;
+        // Sequence numbers start at 1, 0 means nothing was received yet
+        uint64_t m_NextSeq = 1;
+    };
+
+}
@@ -0,0 +1,106 @@
+#include "RateLimiter.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace SlippiAuth {
+
+    TokenBucket::TokenBucket(double rate, double burst, Clock::time_point now)
+        : m_Rate(rate),
+        m_Burst(std::max(burst, 1.0)),
+        m_Tokens(std::max(burst, 1.0)),
+        m_LastRefill(now) {}
+
+    void TokenBucket::Refill(Clock::time_point now)
+    {
+        std::chrono::duration<double> elapsed = now - m_LastRefill;
+        m_Tokens = std::min(m_Burst, m_Tokens + elapsed.count() * m_Rate);
+        m_LastRefill = now;
+    }
+
+    uint32_t TokenBucket::RetryAfter(Clock::time_point now)
+    {
+        if (m_Rate <= 0)
+            return 0;
+
+        Refill(now);
+        if (m_Tokens >= 1.0)
+            return 0;
+
+        return static_cast<uint32_t>(std::ceil((1.0 - m_Tokens) / m_Rate * 1000.0));
+    }
+
+    void TokenBucket::Take()
+    {
+        if (m_Rate > 0)
+            m_Tokens -= 1.0;
+    }
+
+    bool TokenBucket::IsFull(Clock::time_point now)
+    {
+        Refill(now);
+        return m_Tokens >= m_Burst;
+    }
+
+    RateLimiter::RateLimiter(double userRate, double userBurst, double globalRate, double globalBurst)
+        : m_UserRate(userRate),
+        m_UserBurst(userBurst),
+        m_GlobalBucket(globalRate, globalBurst, TokenBucket::Clock::now()) {}
+
+    uint32_t RateLimiter::Admit(uint64_t discordId)
+    {
+        auto now = TokenBucket::Clock::now();
+
+        if (m_UserBuckets.size() >= s_MaxUserBuckets)
+            PruneUserBuckets(now);
+
+        auto& userBucket = m_UserBuckets.try_emplace(discordId, m_UserRate, m_UserBurst, now).first->second;
+
+        // Only take tokens when both buckets agree so a rejection costs nothing
+        uint32_t retryAfter = std::max(userBucket.RetryAfter(now), m_GlobalBucket.RetryAfter(now));
+        if (retryAfter > 0)
+            return retryAfter;
+
+        userBucket.Take();
+        m_GlobalBucket.Take();
+        return 0;
+    }
+
+    void RateLimiter::PruneUserBuckets(TokenBucket::Clock::time_point now)
+    {
+        for (auto iter = m_UserBuckets.begin(); iter != m_UserBuckets.end();)
+        {
+            if (iter->second.IsFull(now))
+                iter = m_UserBuckets.erase(iter);
+            else
+                iter++;
+        }
+    }
+
+    bool IsValidConnectCode(const std::string& connectCode)
+    {
+        size_t hashPos = connectCode.find('#');
+        if (hashPos == std::string::npos || hashPos == 0 || hashPos > 4)
+            return false;
+
+        size_t digitCount = connectCode.size() - hashPos - 1;
+        if (digitCount == 0 || digitCount > 4)
+            return false;
+
+        for (size_t i = 0; i < hashPos; i++)
+        {
+            char c = connectCode[i];
+            if (!((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')))
+                return false;
+        }
+
+        for (size_t i = hashPos + 1; i < connectCode.size(); i++)
+        {
+            if (connectCode[i] < '0' || connectCode[i] > '9')
+                return false;
+        }
+
+        return true;
+    }
+
+}
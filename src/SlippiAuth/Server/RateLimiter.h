@@ -0,0 +1,55 @@
+#pragma once
+
+#include "SlippiAuth/Core.h"
+
+#include <chrono>
+#include <unordered_map>
+
+namespace SlippiAuth {
+
+    class TokenBucket
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // Rate is in tokens per second, a rate of 0 disables the bucket
+        TokenBucket(double rate, double burst, Clock::time_point now);
+
+        // Milliseconds until a token is available, 0 if one is available right now
+        [[nodiscard]] uint32_t RetryAfter(Clock::time_point now);
+        void Take();
+
+        [[nodiscard]] bool IsFull(Clock::time_point now);
+    private:
+        void Refill(Clock::time_point now);
+    private:
+        double m_Rate;
+        double m_Burst;
+        double m_Tokens;
+        Clock::time_point m_LastRefill;
+    };
+
+    class RateLimiter
+    {
+    public:
+        RateLimiter(double userRate, double userBurst, double globalRate, double globalBurst);
+
+        // Returns 0 if the request is admitted, otherwise the retry-after in milliseconds
+        uint32_t Admit(uint64_t discordId);
+    private:
+        void PruneUserBuckets(TokenBucket::Clock::time_point now);
+    private:
+        double m_UserRate;
+        double m_UserBurst;
+
+        TokenBucket m_GlobalBucket;
+        std::unordered_map<uint64_t, TokenBucket> m_UserBuckets;
+
+        // Full buckets are dropped once the map grows past this size
+        static constexpr size_t s_MaxUserBuckets = 4096;
+    };
+
+    // Cheap check of the TAG#123 shape before a request takes a bot
+    bool IsValidConnectCode(const std::string& connectCode);
+
+}
@@ -1,8 +1,20 @@
 #include "Server.h"
 
+#include "SlippiAuth/AppConfig.h"
+#include "SlippiAuth/Probes.h"
+
 namespace SlippiAuth
 {
-    Server::Server(uint16_t port) : m_Port(port)
+    Server::Server(uint16_t port, const std::string& unixSocketPath) :
+        m_History(AppConfig::Value("server", "replayBuffer", (size_t)1024)),
+        m_Port(port),
+        m_DrainTimeout(AppConfig::Value("server", "drainTimeout", 120000u)),
+        m_RateLimiter(
+            AppConfig::Value("rateLimit", "userRate", 0.2),
+            AppConfig::Value("rateLimit", "userBurst", 3.0),
+            AppConfig::Value("rateLimit", "globalRate", 20.0),
+            AppConfig::Value("rateLimit", "globalBurst", 40.0)
+            )
     {
         m_Server.init_asio();
 
@@ -30,10 +42,44 @@ namespace SlippiAuth
         // Remove address-in-use exception when restarting
         m_Server.set_reuse_addr(true);
 
-        m_Server.listen(port);
+#ifdef SO_REUSEPORT
+        // Lets the next process listen while this one drains
+        if (AppConfig::Value("server", "reusePort", true))
+        {
+            m_Server.set_tcp_pre_bind_handler([](const auto& acceptor)
+            {
+                asio::error_code ec;
+                acceptor->set_option(asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true), ec);
+                return ec;
+            });
+        }
+#endif
+
+        // Port 0 only serves the unix socket
+        if (port != 0)
+            m_Server.listen(port);
+
+        if (!unixSocketPath.empty())
+        {
+            m_UnixListener = std::make_unique<UnixSocketListener>(m_Server.get_io_service(), unixSocketPath,
+                [this](const std::string& payload, const ReplyFn& reply)
+                {
+                    HandleMessage(payload, reply);
+                });
+        }
 
         // Set logger
         m_Server.clear_access_channels(websocketpp::log::elevel::rerror);
+
+        // Deploys stop the server with SIGTERM, drain instead of dropping the running authentications
+        m_Signals = std::make_unique<asio::signal_set>(m_Server.get_io_service(), SIGTERM);
+        m_Signals->async_wait([this](const asio::error_code& ec, int)
+        {
+            if (!ec)
+                Drain();
+        });
+
+        m_DrainTimer = std::make_unique<asio::steady_timer>(m_Server.get_io_service());
     }
 
     void Server::OnEvent(Event& e)
@@ -46,6 +92,10 @@ namespace SlippiAuth
         dispatcher.Dispatch<SlippiErrorEvent>(BIND_EVENT_FN(Server::OnSlippiError));
         dispatcher.Dispatch<TimeoutEvent>(BIND_EVENT_FN(Server::OnTimeout));
         dispatcher.Dispatch<NoReadyClientEvent>(BIND_EVENT_FN(Server::OnNoReadyClient));
+        dispatcher.Dispatch<QueuedEvent>(BIND_EVENT_FN(Server::OnQueued));
+        dispatcher.Dispatch<CancelledEvent>(BIND_EVENT_FN(Server::OnCancelled));
+        dispatcher.Dispatch<UpstreamDownEvent>(BIND_EVENT_FN(Server::OnUpstreamDown));
+        dispatcher.Dispatch<AbortedEvent>(BIND_EVENT_FN(Server::OnAborted));
     }
 
     bool Server::OnClientSpawn(SearchingEvent& e)
@@ -53,6 +103,7 @@ namespace SlippiAuth
         Json message = {
                 {"type", "searching"},
                 {"discordId", e.GetDiscordId()},
+                {"requestId", e.GetRequestId()},
                 {"botCode", e.GetBotConnectCode()},
                 {"userCode", e.GetUserConnectCode()}
         };
@@ -111,60 +162,296 @@ namespace SlippiAuth
         return true;
     }
 
+    bool Server::OnQueued(QueuedEvent& e)
+    {
+        Json message = {
+                {"type", "queued"},
+                {"discordId", e.GetDiscordId()},
+                {"requestId", e.GetRequestId()},
+                {"userCode", e.GetUserConnectCode()},
+                {"position", e.GetPosition()}
+        };
+
+        SendMessage(message);
+        return true;
+    }
+
+    bool Server::OnCancelled(CancelledEvent& e)
+    {
+        Json message = {
+                {"type", "cancelled"},
+                {"discordId", e.GetDiscordId()},
+                {"userCode", e.GetUserConnectCode()}
+        };
+
+        SendMessage(message);
+        return true;
+    }
+
+    bool Server::OnUpstreamDown(UpstreamDownEvent& e)
+    {
+        Json message = {
+                {"type", "upstreamDown"},
+                {"discordId", e.GetDiscordId()},
+                {"userCode", e.GetUserConnectCode()},
+                {"retryAfter", e.GetRetryAfter()}
+        };
+
+        SendMessage(message);
+        return true;
+    }
+
+    bool Server::OnAborted(AbortedEvent& e)
+    {
+        Json message = {
+                {"type", "aborted"},
+                {"discordId", e.GetDiscordId()},
+                {"userCode", e.GetUserConnectCode()}
+        };
+
+        SendMessage(message);
+        return true;
+    }
+
     void Server::OnOpen(const websocketpp::connection_hdl& hdl)
     {
         SERVER_INFO("A websocket client connected");
+
+        std::lock_guard<std::mutex> lock(m_ConnectionMutex);
         m_ConnectionHandles.push_back(hdl);
     }
 
     void Server::OnMessage(const websocketpp::connection_hdl& hdl, const MessagePtr& msg)
     {
-        try
+        const std::string& request = msg->get_payload();
+        SLIPPIAUTH_PROBE(message_start, request.c_str(), request.size());
+        auto start = std::chrono::steady_clock::now();
+
+        HandleMessage(request, [this, hdl, opcode = msg->get_opcode()](const std::string& payload)
         {
-            // Deserialize json
             try
             {
-                auto payload = msg->get_payload();
-                if (payload == "ping") {
-                    m_Server.send(hdl, "pong", msg->get_opcode());
-                } else {
-                    Json message = Json::parse(payload);
-                    SERVER_TRACE("Received {} message", message["type"]);
-                    if (message["type"] == "queue")
-                    {
-                        if (message.contains("userCode") && message.contains("timeout") && message.contains("discordId"))
-                        {
-                            QueueEvent event(message["userCode"], message["timeout"], message["discordId"]);
-                            m_EventCallback(event);
-                        }
-                        else
-                        {
-                            OnMissingArg(hdl, "code, timeout or discordId");
-                        }
-                    }
-                    else if (message["type"] == "stopListening")
-                    {
+                m_Server.send(hdl, payload, opcode);
+            }
+            catch (const websocketpp::exception& e)
+            {
+                SERVER_ERROR("Failed to send message: {}", e.what());
+            }
+        });
+
+        [[maybe_unused]] auto handled = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start);
+        SLIPPIAUTH_PROBE(message_done, request.c_str(), request.size(), handled.count());
+    }
+
+    void Server::HandleMessage(const std::string& payload, const ReplyFn& reply)
+    {
+        // Deserialize json
+        try
+        {
+            if (payload == "ping") {
+                reply("pong");
+            } else {
+                Json message = Json::parse(payload);
+                SERVER_TRACE("Received {} message", message["type"]);
+                if (message["type"] == "queue")
+                {
+                    OnQueueMessage(reply, message);
+                }
+                else if (message["type"] == "cancel")
+                {
+                    OnCancelMessage(reply, message);
+                }
+                else if (message["type"] == "resume")
+                {
+                    OnResumeMessage(reply, message);
+                }
+                else if (message["type"] == "status")
+                {
+                    OnStatusMessage(reply);
+                }
+                else if (message["type"] == "stopListening")
+                {
+                    if (m_Port != 0)
                         m_Server.stop_listening();
-                    }
-                    else
-                    {
-                        Json response = {{"type", "unknownCommand"}};
-                        m_Server.send(hdl, response.dump(), msg->get_opcode());
-                    }
+                }
+                else if (message["type"] == "drain")
+                {
+                    Drain();
+                }
+                else
+                {
+                    Json response = {{"type", "unknownCommand"}};
+                    SendMessage(reply, response);
                 }
             }
-            catch (const nlohmann::detail::parse_error& e)
+        }
+        catch (const nlohmann::detail::parse_error& e)
+        {
+            Json response = {{"type", "jsonErr"}};
+            SendMessage(reply, response);
+        }
+    }
+
+    void Server::OnQueueMessage(const ReplyFn& reply, const Json& message)
+    {
+        if (!message.contains("userCode") || !message.contains("timeout") || !message.contains("discordId"))
+        {
+            OnMissingArg(reply, "code, timeout or discordId");
+            return;
+        }
+
+        const Json& userCode = message["userCode"];
+        if (!userCode.is_string() || !IsValidConnectCode(userCode))
+        {
+            OnInvalidArg(reply, "userCode");
+            return;
+        }
+
+        if (!message["timeout"].is_number_unsigned() || !message["discordId"].is_number_unsigned())
+        {
+            OnInvalidArg(reply, "timeout or discordId");
+            return;
+        }
+
+        QueuePriority priority = QueuePriority::Normal;
+        if (message.contains("priority"))
+        {
+            if (message["priority"] == "high")
+                priority = QueuePriority::High;
+            else if (message["priority"] != "normal")
             {
-                Json response = {{"type", "jsonErr"}};
-                m_Server.send(hdl, response.dump(), msg->get_opcode());
+                OnInvalidArg(reply, "priority");
+                return;
             }
         }
-        catch (const websocketpp::exception& e)
+
+        uint64_t discordId = message["discordId"];
+
+        // The next process takes the new requests
+        if (m_Draining)
         {
-            SERVER_ERROR("Failed to send message: {}", e.what());
+            Json response = {
+                    {"type", "draining"},
+                    {"discordId", discordId},
+                    {"userCode", userCode}
+            };
+
+            SendMessage(reply, response);
+            return;
+        }
+
+        uint32_t retryAfter = m_RateLimiter.Admit(discordId);
+        if (retryAfter > 0)
+        {
+            OnRateLimited(reply, discordId, userCode, retryAfter);
+            return;
+        }
+
+        QueueEvent event(userCode, message["timeout"], discordId, priority);
+        m_EventCallback(event);
+    }
+
+    void Server::OnCancelMessage(const ReplyFn& reply, const Json& message)
+    {
+        if (!message.contains("discordId"))
+        {
+            OnMissingArg(reply, "discordId");
+            return;
+        }
+
+        if (!message["discordId"].is_number_unsigned())
+        {
+            OnInvalidArg(reply, "discordId");
+            return;
+        }
+
+        std::optional<uint64_t> requestId;
+        if (message.contains("requestId"))
+        {
+            if (!message["requestId"].is_number_unsigned())
+            {
+                OnInvalidArg(reply, "requestId");
+                return;
+            }
+            requestId = message["requestId"];
+        }
+
+        CancelEvent event(message["discordId"], requestId);
+        m_EventCallback(event);
+
+        if (!event.Handled)
+        {
+            Json response = {
+                    {"type", "nothingToCancel"},
+                    {"discordId", event.GetDiscordId()}
+            };
+            if (requestId)
+                response["requestId"] = *requestId;
+
+            SendMessage(reply, response);
         }
     }
 
+    void Server::OnResumeMessage(const ReplyFn& reply, const Json& message)
+    {
+        if (!message.contains("lastSeq"))
+        {
+            OnMissingArg(reply, "lastSeq");
+            return;
+        }
+
+        if (!message["lastSeq"].is_number_unsigned())
+        {
+            OnInvalidArg(reply, "lastSeq");
+            return;
+        }
+
+        // Without an epoch the sequence number can't be trusted, it is fully replayed
+        std::string epoch;
+        if (message.contains("epoch"))
+        {
+            if (!message["epoch"].is_string())
+            {
+                OnInvalidArg(reply, "epoch");
+                return;
+            }
+            epoch = message["epoch"];
+        }
+
+        // Hold the lock so no event is broadcast between the replay and the live ones
+        std::lock_guard<std::mutex> lock(m_ConnectionMutex);
+
+        std::string events;
+        bool complete = m_History.Since(epoch, message["lastSeq"], events);
+
+        // Built by hand to reuse the serialized events, the epoch is hex so needs no escaping
+        std::string payload = fmt::format(
+            R"({{"type":"replay","complete":{},"epoch":"{}","lastSeq":{},"events":{}}})",
+            complete, m_History.GetEpoch(), m_History.GetLastSeq(), events);
+        reply(payload);
+    }
+
+    void Server::OnStatusMessage(const ReplyFn& reply)
+    {
+        StatusEvent event;
+        m_EventCallback(event);
+
+        const auto& snapshot = event.GetSnapshot();
+        Json response = {
+                {"type", "status"},
+                {"idle", snapshot.idle},
+                {"searching", snapshot.searching},
+                {"connecting", snapshot.connecting},
+                {"quarantined", snapshot.quarantined},
+                {"running", snapshot.running},
+                {"queueDepth", snapshot.queueDepth},
+                {"oldestRequestAge", snapshot.oldestRequestAge}
+        };
+
+        SendMessage(reply, response);
+    }
+
     void Server::OnFail(const websocketpp::connection_hdl& hdl)
     {
         WsServer::connection_ptr con = m_Server.get_con_from_hdl(hdl);
@@ -175,6 +462,7 @@ namespace SlippiAuth
     {
         SERVER_INFO("A websocket client disconnected");
 
+        std::lock_guard<std::mutex> lock(m_ConnectionMutex);
         auto iter = std::find_if(m_ConnectionHandles.begin(), m_ConnectionHandles.end(),
                 [=](const websocketpp::connection_hdl& hdl2)
                 {
@@ -189,22 +477,119 @@ namespace SlippiAuth
 
     void Server::Start()
     {
-        SERVER_INFO("Server started on port {}", m_Port);
-        m_Server.start_accept();
+        if (m_Port != 0)
+        {
+            SERVER_INFO("Server started on port {}", m_Port);
+            m_Server.start_accept();
+        }
+
+        if (m_UnixListener)
+            m_UnixListener->Start();
+
         m_Server.run();
     }
 
-    void Server::SendMessage(const Json& message)
+    void Server::Drain()
+    {
+        if (m_Draining.exchange(true))
+            return;
+
+        SERVER_INFO("Draining, new requests are refused until the running ones are done");
+
+        // Connected consumers keep receiving the results of their requests
+        if (m_Port != 0)
+        {
+            std::error_code ec;
+            m_Server.stop_listening(ec);
+        }
+
+        if (m_UnixListener)
+            m_UnixListener->StopAccepting();
+
+        m_DrainDeadline = std::chrono::steady_clock::now() + m_DrainTimeout;
+        CheckDrained();
+    }
+
+    void Server::CheckDrained()
+    {
+        StatusEvent event;
+        m_EventCallback(event);
+
+        const auto& snapshot = event.GetSnapshot();
+        // Not the client states, a client already taken from the queue only changes state once its thread runs
+        size_t running = snapshot.running + snapshot.queueDepth;
+
+        if (running > 0 && std::chrono::steady_clock::now() < m_DrainDeadline)
+        {
+            m_DrainTimer->expires_after(s_DrainCheckInterval);
+            m_DrainTimer->async_wait([this](const asio::error_code& ec)
+            {
+                if (!ec)
+                    CheckDrained();
+            });
+            return;
+        }
+
+        if (running > 0)
+            SERVER_WARN("Drain timed out with {} requests left", running);
+        else
+            SERVER_INFO("Drained, closing the connections");
+
+        // run() returns once the last connection is closed
+        asio::error_code signalError;
+        m_Signals->cancel(signalError);
+
+        std::vector<websocketpp::connection_hdl> handles;
+        {
+            std::lock_guard<std::mutex> lock(m_ConnectionMutex);
+            handles = m_ConnectionHandles;
+        }
+
+        for (auto& hdl : handles)
+        {
+            std::error_code ec;
+            m_Server.close(hdl, websocketpp::close::status::going_away, "shutting down", ec);
+        }
+
+        if (m_UnixListener)
+            m_UnixListener->Stop();
+    }
+
+    void Server::Stop()
+    {
+        if (m_UnixListener)
+            m_UnixListener->Stop();
+
+        m_Server.stop();
+    }
+
+    size_t Server::GetConnectionCount()
+    {
+        size_t count = m_UnixListener ? m_UnixListener->GetSessionCount() : 0;
+
+        std::lock_guard<std::mutex> lock(m_ConnectionMutex);
+        return count + m_ConnectionHandles.size();
+    }
+
+    void Server::SendMessage(Json message)
     {
         try
         {
+            std::lock_guard<std::mutex> lock(m_ConnectionMutex);
+
+            // Serialize once for every connection and the history
+            std::string payload = m_History.Append(message);
+            SLIPPIAUTH_PROBE(broadcast, payload.c_str(), payload.size(), m_ConnectionHandles.size());
             for (auto& hdl : m_ConnectionHandles)
             {
                 if (!hdl.expired())
                 {
-                    m_Server.send(hdl, message.dump(), websocketpp::frame::opcode::text);
+                    m_Server.send(hdl, payload, websocketpp::frame::opcode::text);
                 }
             }
+
+            if (m_UnixListener)
+                m_UnixListener->Broadcast(payload);
         }
         catch (const websocketpp::exception& e)
         {
@@ -212,26 +597,42 @@ namespace SlippiAuth
         }
     }
 
-    void Server::SendMessage(const websocketpp::connection_hdl& hdl, const Json& message)
+    void Server::SendMessage(const ReplyFn& reply, const Json& message)
     {
-        try
-        {
-            m_Server.send(hdl, message.dump(), websocketpp::frame::opcode::text);
-        }
-        catch (const websocketpp::exception& e)
-        {
-            SERVER_ERROR("Failed to send message: {}", e.what());
-        }
+        reply(message.dump());
     }
 
-    void Server::OnMissingArg(const websocketpp::connection_hdl& hdl, const std::string& argName)
+    void Server::OnMissingArg(const ReplyFn& reply, const std::string& argName)
     {
         Json message = {
                 {"type", "missingArg"},
                 {"what", argName}
         };
 
-        SendMessage(hdl, message);
+        SendMessage(reply, message);
+    }
+
+    void Server::OnInvalidArg(const ReplyFn& reply, const std::string& argName)
+    {
+        Json message = {
+                {"type", "invalidArg"},
+                {"what", argName}
+        };
+
+        SendMessage(reply, message);
+    }
+
+    void Server::OnRateLimited(const ReplyFn& reply, uint64_t discordId,
+                               const std::string& userCode, uint32_t retryAfter)
+    {
+        Json message = {
+                {"type", "rateLimited"},
+                {"discordId", discordId},
+                {"userCode", userCode},
+                {"retryAfter", retryAfter}
+        };
+
+        SendMessage(reply, message);
     }
 
 }
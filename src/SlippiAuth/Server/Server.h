@@ -4,6 +4,9 @@
 #define ASIO_STANDALONE
 
 #include "Util/CustomConfig.h"
+#include "EventHistory.h"
+#include "RateLimiter.h"
+#include "UnixSocketListener.h"
 #include "SlippiAuth/Events/ServerEvent.h"
 #include "SlippiAuth/Events/ClientEvent.h"
 #include "SlippiAuth/Events/ClientPoolEvent.h"
@@ -14,7 +17,8 @@ namespace SlippiAuth {
     class Server
     {
     public:
-        explicit Server(uint16_t port);
+        // A port of 0 disables the websocket listener, an empty path the unix socket one
+        explicit Server(uint16_t port, const std::string& unixSocketPath = "");
 
         void OnEvent(Event& e);
         inline void SetEventCallback(const EventCallbackFn& callback)
@@ -23,6 +27,15 @@ namespace SlippiAuth {
         }
 
         void Start();
+        void Stop();
+
+        // Refuse new requests, wait for the running ones then close every connection so Start returns
+        void Drain();
+
+        [[nodiscard]] size_t GetConnectionCount();
+
+        // Commands from websocket and unix socket clients alike, and from the simulation
+        void HandleMessage(const std::string& payload, const ReplyFn& reply);
     private:
         // Events coming from clients
         bool OnClientSpawn(SearchingEvent& e);
@@ -30,6 +43,10 @@ namespace SlippiAuth {
         bool OnSlippiError(SlippiErrorEvent& e);
         bool OnTimeout(TimeoutEvent& e);
         bool OnNoReadyClient(NoReadyClientEvent& e);
+        bool OnQueued(QueuedEvent& e);
+        bool OnCancelled(CancelledEvent& e);
+        bool OnUpstreamDown(UpstreamDownEvent& e);
+        bool OnAborted(AbortedEvent& e);
 
         // Core server handlers
         void OnOpen(const websocketpp::connection_hdl& hdl);
@@ -37,18 +54,48 @@ namespace SlippiAuth {
         void OnFail(const websocketpp::connection_hdl& hdl);
         void OnClose(const websocketpp::connection_hdl& hdl);
 
+        // Polls the pool until nothing is running, must be called on the io thread
+        void CheckDrained();
+
+        // Commands
+        void OnQueueMessage(const ReplyFn& reply, const Json& message);
+        void OnCancelMessage(const ReplyFn& reply, const Json& message);
+        void OnResumeMessage(const ReplyFn& reply, const Json& message);
+        void OnStatusMessage(const ReplyFn& reply);
+
         // Other server handlers
-        void OnMissingArg(const websocketpp::connection_hdl& hdl, const std::string& argName);
+        void OnMissingArg(const ReplyFn& reply, const std::string& argName);
+        void OnInvalidArg(const ReplyFn& reply, const std::string& argName);
+        void OnRateLimited(const ReplyFn& reply, uint64_t discordId,
+                           const std::string& userCode, uint32_t retryAfter);
 
-        // Send message to every connected clients
-        void SendMessage(const Json& message);
+        // Send message to every connected clients, stamped with a sequence number
+        void SendMessage(Json message);
         // Send message to one client
-        void SendMessage(const websocketpp::connection_hdl& hdl, const Json& message);
+        void SendMessage(const ReplyFn& reply, const Json& message);
     private:
+        // Clients send their events from their own threads
+        std::mutex m_ConnectionMutex;
         std::vector<websocketpp::connection_hdl> m_ConnectionHandles;
+        // Guarded by m_ConnectionMutex so sequence numbers go out in order
+        EventHistory m_History;
         WsServer m_Server;
         uint16_t m_Port;
 
+        std::atomic<bool> m_Draining = false;
+        std::chrono::milliseconds m_DrainTimeout;
+        std::chrono::steady_clock::time_point m_DrainDeadline{};
+        // Created once asio is initialized
+        std::unique_ptr<asio::signal_set> m_Signals;
+        std::unique_ptr<asio::steady_timer> m_DrainTimer;
+
+        static constexpr auto s_DrainCheckInterval = std::chrono::milliseconds(250);
+        // Runs on the io service of m_Server
+        std::unique_ptr<UnixSocketListener> m_UnixListener;
+
+        // Admission control for queue requests
+        RateLimiter m_RateLimiter;
+
         EventCallbackFn m_EventCallback;
     };
 
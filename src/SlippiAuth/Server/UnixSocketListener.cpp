@@ -0,0 +1,248 @@
+#include "UnixSocketListener.h"
+
+#include <filesystem>
+
+#include <sys/stat.h>
+
+namespace SlippiAuth {
+
+    UnixSession::UnixSession(asio::local::stream_protocol::socket socket, UnixSocketListener& listener)
+        : m_Socket(std::move(socket)), m_Listener(listener) {}
+
+    void UnixSession::Start()
+    {
+        ReadHeader();
+    }
+
+    void UnixSession::Send(const std::string& payload)
+    {
+        std::string frame(4, '\0');
+        auto length = (uint32_t)payload.size();
+        for (int i = 0; i < 4; i++)
+            frame[i] = (char)((length >> (24 - 8 * i)) & 0xFF);
+        frame += payload;
+
+        asio::post(m_Socket.get_executor(), [self = shared_from_this(), frame = std::move(frame)]() mutable
+        {
+            self->m_WriteQueue.push_back(std::move(frame));
+
+            // Otherwise the running write picks it up
+            if (self->m_WriteQueue.size() == 1)
+                self->WriteNext();
+        });
+    }
+
+    void UnixSession::Close()
+    {
+        asio::error_code ec;
+        m_Socket.close(ec);
+    }
+
+    void UnixSession::Shutdown()
+    {
+        // Must run on the io thread, the pending messages are written first
+        m_Closing = true;
+        if (m_WriteQueue.empty())
+            Close();
+    }
+
+    void UnixSession::ReadHeader()
+    {
+        asio::async_read(m_Socket, asio::buffer(m_Header), [self = shared_from_this()](const asio::error_code& ec, size_t)
+        {
+            if (ec)
+            {
+                self->m_Listener.OnClose(self);
+                return;
+            }
+
+            uint32_t length = 0;
+            for (uint8_t byte : self->m_Header)
+                length = (length << 8) | byte;
+
+            if (length > UnixSocketListener::MaxMessageSize)
+            {
+                SERVER_ERROR("Closing a unix socket client that sent {} bytes", length);
+                self->Close();
+                self->m_Listener.OnClose(self);
+                return;
+            }
+
+            self->ReadBody(length);
+        });
+    }
+
+    void UnixSession::ReadBody(uint32_t length)
+    {
+        m_Body.resize(length);
+        asio::async_read(m_Socket, asio::buffer(m_Body), [self = shared_from_this()](const asio::error_code& ec, size_t)
+        {
+            if (ec)
+            {
+                self->m_Listener.OnClose(self);
+                return;
+            }
+
+            self->m_Listener.OnMessage(self, self->m_Body);
+            self->ReadHeader();
+        });
+    }
+
+    void UnixSession::WriteNext()
+    {
+        asio::async_write(m_Socket, asio::buffer(m_WriteQueue.front()), [self = shared_from_this()](const asio::error_code& ec, size_t)
+        {
+            if (ec)
+            {
+                // The read side reports the disconnection
+                self->m_WriteQueue.clear();
+                return;
+            }
+
+            self->m_WriteQueue.pop_front();
+            if (!self->m_WriteQueue.empty())
+                self->WriteNext();
+            else if (self->m_Closing)
+                self->Close();
+        });
+    }
+
+    UnixSocketListener::UnixSocketListener(asio::io_service& ioService, std::string path, MessageFn onMessage)
+        : m_IoService(ioService), m_Acceptor(ioService), m_RetryTimer(ioService), m_Path(std::move(path)), m_OnMessage(std::move(onMessage))
+    {
+        // A socket file left by a previous run would make bind fail
+        std::error_code fsError;
+        std::filesystem::remove(m_Path, fsError);
+
+        try
+        {
+            asio::local::stream_protocol::endpoint endpoint(m_Path);
+            m_Acceptor.open(endpoint.protocol());
+            m_Acceptor.bind(endpoint);
+            m_Acceptor.listen();
+        }
+        catch (const std::system_error& e)
+        {
+            SERVER_ERROR("Cannot listen on unix socket {}: {}", m_Path, e.what());
+            throw;
+        }
+
+        struct stat info{};
+        if (stat(m_Path.c_str(), &info) == 0)
+            m_Inode = info.st_ino;
+    }
+
+    UnixSocketListener::~UnixSocketListener()
+    {
+        // A new process may have replaced the socket file while this one was draining
+        struct stat info{};
+        if (stat(m_Path.c_str(), &info) == 0 && info.st_ino == m_Inode)
+        {
+            std::error_code fsError;
+            std::filesystem::remove(m_Path, fsError);
+        }
+    }
+
+    void UnixSocketListener::Start()
+    {
+        SERVER_INFO("Listening on unix socket {}", m_Path);
+        Accept();
+    }
+
+    void UnixSocketListener::Stop()
+    {
+        // Sockets are only touched on the io thread
+        asio::post(m_IoService, [this]()
+        {
+            asio::error_code ec;
+            m_Acceptor.close(ec);
+            m_RetryTimer.cancel();
+
+            std::lock_guard<std::mutex> lock(m_SessionMutex);
+            for (auto& session : m_Sessions)
+                session->Shutdown();
+        });
+    }
+
+    void UnixSocketListener::StopAccepting()
+    {
+        asio::post(m_IoService, [this]()
+        {
+            asio::error_code ec;
+            m_Acceptor.close(ec);
+            m_RetryTimer.cancel();
+        });
+    }
+
+    void UnixSocketListener::Broadcast(const std::string& payload)
+    {
+        std::lock_guard<std::mutex> lock(m_SessionMutex);
+        for (auto& session : m_Sessions)
+            session->Send(payload);
+    }
+
+    size_t UnixSocketListener::GetSessionCount()
+    {
+        std::lock_guard<std::mutex> lock(m_SessionMutex);
+        return m_Sessions.size();
+    }
+
+    void UnixSocketListener::Accept()
+    {
+        m_Acceptor.async_accept([this](const asio::error_code& ec, asio::local::stream_protocol::socket socket)
+        {
+            // The acceptor was closed
+            if (ec == asio::error::operation_aborted)
+                return;
+
+            if (ec)
+            {
+                // Out of descriptors for instance, accepting again right away would spin the io thread
+                SERVER_ERROR("Cannot accept on unix socket {}: {}", m_Path, ec.message());
+                RetryAccept();
+                return;
+            }
+
+            SERVER_INFO("A unix socket client connected");
+
+            auto session = std::make_shared<UnixSession>(std::move(socket), *this);
+            {
+                std::lock_guard<std::mutex> lock(m_SessionMutex);
+                m_Sessions.insert(session);
+            }
+            session->Start();
+
+            Accept();
+        });
+    }
+
+    void UnixSocketListener::RetryAccept()
+    {
+        m_RetryTimer.expires_after(s_AcceptRetryDelay);
+        m_RetryTimer.async_wait([this](const asio::error_code& ec)
+        {
+            // Cancelled when the acceptor is closed
+            if (!ec && m_Acceptor.is_open())
+                Accept();
+        });
+    }
+
+    void UnixSocketListener::OnMessage(const std::shared_ptr<UnixSession>& session, const std::string& payload)
+    {
+        std::weak_ptr<UnixSession> weakSession = session;
+        m_OnMessage(payload, [weakSession](const std::string& reply)
+        {
+            if (auto session = weakSession.lock())
+                session->Send(reply);
+        });
+    }
+
+    void UnixSocketListener::OnClose(const std::shared_ptr<UnixSession>& session)
+    {
+        SERVER_INFO("A unix socket client disconnected");
+
+        std::lock_guard<std::mutex> lock(m_SessionMutex);
+        m_Sessions.erase(session);
+    }
+
+}
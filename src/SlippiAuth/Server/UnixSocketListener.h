@@ -0,0 +1,92 @@
+#pragma once
+
+#include "SlippiAuth/Core.h"
+
+#include <asio.hpp>
+
+#include <deque>
+#include <mutex>
+#include <unordered_set>
+
+#include <sys/types.h>
+
+namespace SlippiAuth {
+
+    // Sends a message back to the consumer a command came from
+    using ReplyFn = std::function<void(const std::string&)>;
+
+    class UnixSocketListener;
+
+    // A consumer connected to the unix socket, every message is a 4 bytes big endian length then the json
+    class UnixSession : public std::enable_shared_from_this<UnixSession>
+    {
+    public:
+        UnixSession(asio::local::stream_protocol::socket socket, UnixSocketListener& listener);
+
+        void Start();
+        // Can be called from any thread, the write happens on the io thread
+        void Send(const std::string& payload);
+        void Close();
+        // Close once the pending messages are written
+        void Shutdown();
+    private:
+        void ReadHeader();
+        void ReadBody(uint32_t length);
+        void WriteNext();
+    private:
+        asio::local::stream_protocol::socket m_Socket;
+        UnixSocketListener& m_Listener;
+
+        std::array<uint8_t, 4> m_Header{};
+        std::string m_Body;
+
+        // Only touched on the io thread
+        std::deque<std::string> m_WriteQueue;
+        bool m_Closing = false;
+    };
+
+    class UnixSocketListener
+    {
+    public:
+        using MessageFn = std::function<void(const std::string& payload, const ReplyFn& reply)>;
+
+        // Longer messages close the session
+        static constexpr uint32_t MaxMessageSize = 1 << 20;
+
+        UnixSocketListener(asio::io_service& ioService, std::string path, MessageFn onMessage);
+        ~UnixSocketListener();
+
+        void Start();
+        // Stop accepting and close every session once its pending messages are written
+        void Stop();
+        // The sessions stay open, a new process can take over the socket path
+        void StopAccepting();
+
+        void Broadcast(const std::string& payload);
+        [[nodiscard]] size_t GetSessionCount();
+    private:
+        void Accept();
+        // Accept again after a delay, the error can last while the process is out of descriptors
+        void RetryAccept();
+
+        // Called by the sessions
+        void OnMessage(const std::shared_ptr<UnixSession>& session, const std::string& payload);
+        void OnClose(const std::shared_ptr<UnixSession>& session);
+    private:
+        asio::io_service& m_IoService;
+        asio::local::stream_protocol::acceptor m_Acceptor;
+        asio::steady_timer m_RetryTimer;
+        std::string m_Path;
+        // The socket file is only removed if it is still ours
+        ino_t m_Inode = 0;
+        MessageFn m_OnMessage;
+
+        std::mutex m_SessionMutex;
+        std::unordered_set<std::shared_ptr<UnixSession>> m_Sessions;
+
+        static constexpr std::chrono::milliseconds s_AcceptRetryDelay{100};
+
+        friend class UnixSession;
+    };
+
+}
@@ -1,13 +1,54 @@
 #include "Application.h"
+#include "AppConfig.h"
+
+#include <charconv>
+
+// One entry of log.clientLevels, false if it cannot be applied
+static bool ParseClientLevel(const std::string& key, const SlippiAuth::Json& value,
+                             uint16_t& client, spdlog::level::level_enum& level)
+{
+    unsigned int id;
+    auto [end, error] = std::from_chars(key.data(), key.data() + key.size(), id);
+    if (error != std::errc() || end != key.data() + key.size() || id > UINT16_MAX || !value.is_string())
+        return false;
+
+    // Unknown names parse as off
+    const std::string& name = value.get_ref<const std::string&>();
+    level = spdlog::level::from_str(name);
+    if (level == spdlog::level::off && name != "off")
+        return false;
+
+    client = (uint16_t)id;
+    return true;
+}
 
 int main()
 {
     // Load config
     SlippiAuth::ClientConfig::Load("clients.json");
+    SlippiAuth::AppConfig::Load("config.json");
 
     // Init logs
-    size_t poolSize = SlippiAuth::ClientConfig::Get().size();
-    SlippiAuth::Log::Init(poolSize);
+    SlippiAuth::Log::Init(SlippiAuth::AppConfig::Value<std::string>("log", "format", "text") == "json");
+    SlippiAuth::Log::SetClientLevel(spdlog::level::from_str(
+            SlippiAuth::AppConfig::Value<std::string>("log", "clientLevel", "trace")));
+
+    // Per client levels, keyed by client id, a bad entry is skipped rather than failing the startup
+    auto clientLevels = SlippiAuth::AppConfig::Value("log", "clientLevels", SlippiAuth::Json::object());
+    if (!clientLevels.is_object())
+        CORE_WARN("log.clientLevels must map client ids to levels, ignoring it");
+    else
+    {
+        for (auto& [key, value] : clientLevels.items())
+        {
+            uint16_t client;
+            spdlog::level::level_enum level;
+            if (ParseClientLevel(key, value, client, level))
+                SlippiAuth::Log::SetClientLevel(client, level);
+            else
+                CORE_WARN("Ignoring the log level {} of client \"{}\"", value.dump(), key);
+        }
+    }
 
     // Start application
     SlippiAuth::Application application;